@@ -1,4 +1,5 @@
 #version 450
+#pragma keywords INVERT
 
 layout(set = 0, binding = 2) uniform sampler2D textureSampler;
 
@@ -10,4 +11,7 @@ layout(location = 0) out vec4 outColor;
 void main()
 {
     outColor = vec4(fragColor * texture(textureSampler, fragTexCoord).rgb, 1.0);
+#if INVERT
+    outColor = vec4(1.0, 1.0, 1.0, 2.0) - outColor;
+#endif
 }
\ No newline at end of file
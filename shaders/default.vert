@@ -16,6 +16,7 @@ layout(push_constant) uniform PushConstants
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inColor;
 layout(location = 2) in vec2 inTexCoord;
+layout(location = 3) in mat4 inModel;
 
 layout(location = 0) out vec3 fragColor;
 layout(location = 1) out vec2 fragTexCoord;
@@ -26,7 +27,7 @@ void main()
         cos(pushConstants.rotationAngle), sin(pushConstants.rotationAngle),
         -sin(pushConstants.rotationAngle), cos(pushConstants.rotationAngle));
 
-    gl_Position = vec4((rotationMatrix * inPosition.xy + ubo1.offset) * ubo2.scale, inPosition.z, 1.0);
+    gl_Position = inModel * vec4((rotationMatrix * inPosition.xy + ubo1.offset) * ubo2.scale, inPosition.z, 1.0);
 
     fragColor = inColor;
     fragTexCoord = inTexCoord;
@@ -0,0 +1,32 @@
+#include "BehaviourDispatcher.hpp"
+
+namespace boza
+{
+    void BehaviourDispatcher::start()
+    {
+        for (size_t i = 0; const auto batch = instance().get_batch(i); ++i)
+        {
+            if (batch->start != nullptr) batch->start();
+        }
+    }
+
+    void BehaviourDispatcher::update(const duration& dt) { dispatch(&Batch::update, dt); }
+    void BehaviourDispatcher::fixed_update(const duration& dt) { dispatch(&Batch::fixed_update, dt); }
+    void BehaviourDispatcher::late_update(const duration& dt) { dispatch(&Batch::late_update, dt); }
+
+    void BehaviourDispatcher::dispatch(hook Batch::* member, const duration& dt)
+    {
+        for (size_t i = 0; const auto batch = instance().get_batch(i); ++i)
+        {
+            if (const hook run = *batch.*member; run != nullptr) run(dt);
+        }
+    }
+
+    std::optional<BehaviourDispatcher::Batch> BehaviourDispatcher::get_batch(const size_t index)
+    {
+        // hooks may register new types while we iterate
+        std::lock_guard lock{ mutex };
+        if (index >= batches.size()) return std::nullopt;
+        return batches[index];
+    }
+}
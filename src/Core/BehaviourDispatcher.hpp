@@ -0,0 +1,48 @@
+#pragma once
+#include "boza_pch.hpp"
+#include "Singleton.hpp"
+#include "Components/Behaviour.hpp"
+#include "Components/GameObjData.hpp"
+
+namespace boza
+{
+    // Runs behaviour hooks type by type over the contiguous component storage, for objects of the active scene.
+    // Hooks a type does not override are never visited; overrides must be public.
+    class BOZA_API BehaviourDispatcher final : public Singleton<BehaviourDispatcher>
+    {
+    public:
+        template<behaviour_derived T>
+        static void register_type();
+
+        static void start();
+        static void update(const duration& dt);
+        static void fixed_update(const duration& dt);
+        static void late_update(const duration& dt);
+
+    private:
+        using start_hook = void(*)();
+        using hook       = void(*)(const duration&);
+
+        struct Batch
+        {
+            start_hook start{ nullptr };
+            hook       update{ nullptr };
+            hook       fixed_update{ nullptr };
+            hook       late_update{ nullptr };
+        };
+
+        template<behaviour_derived T, typename F>
+        static void for_each(F&& func);
+
+        static void dispatch(hook Batch::* member, const duration& dt);
+        [[nodiscard]] std::optional<Batch> get_batch(size_t index);
+
+        std::vector<Batch> batches;
+        std::mutex         mutex;
+
+        friend Singleton;
+        BehaviourDispatcher() = default;
+    };
+}
+
+#include "BehaviourDispatcher.inl"
@@ -0,0 +1,69 @@
+#pragma once
+#include "BehaviourDispatcher.hpp"
+#include "Scene.hpp"
+#include "JobSystem/JobSystem.hpp"
+
+namespace boza
+{
+    template<behaviour_derived T>
+    void BehaviourDispatcher::register_type()
+    {
+        // an override that is not public could be neither detected nor called through T
+        static_assert(requires { &T::start; &T::update; &T::fixed_update; &T::late_update; },
+                      "Behaviour hooks must be overridden as public members");
+
+        // &T::hook keeps Behaviour's member type until a class between Behaviour and T declares it
+        constexpr bool has_start        = requires { requires !std::same_as<decltype(&T::start), void (Behaviour::*)()>; };
+        constexpr bool has_update       = requires { requires !std::same_as<decltype(&T::update), void (Behaviour::*)(const duration&)>; };
+        constexpr bool has_fixed_update = requires { requires !std::same_as<decltype(&T::fixed_update), void (Behaviour::*)(const duration&)>; };
+        constexpr bool has_late_update  = requires { requires !std::same_as<decltype(&T::late_update), void (Behaviour::*)(const duration&)>; };
+
+        static const bool registered = []
+        {
+            Batch batch{};
+
+            if constexpr (has_start)
+                batch.start = [] { for_each<T>([](T& behaviour) { behaviour.T::start(); }); };
+            if constexpr (has_update)
+                batch.update = [](const duration& dt) { for_each<T>([&dt](T& behaviour) { behaviour.T::update(dt); }); };
+            if constexpr (has_fixed_update)
+                batch.fixed_update = [](const duration& dt) { for_each<T>([&dt](T& behaviour) { behaviour.T::fixed_update(dt); }); };
+            if constexpr (has_late_update)
+                batch.late_update = [](const duration& dt) { for_each<T>([&dt](T& behaviour) { behaviour.T::late_update(dt); }); };
+
+            auto& inst = instance();
+            std::lock_guard lock{ inst.mutex };
+            inst.batches.push_back(batch);
+
+            return true;
+        }();
+
+        (void)registered;
+    }
+
+    template<behaviour_derived T, typename F>
+    void BehaviourDispatcher::for_each(F&& func)
+    {
+        // the registry is shared by every scene, only objects of the active one are dispatched
+        const Scene* scene = Scene::active_scene();
+        if (scene == nullptr) return;
+
+        auto view = Scene::view<T, const GameObjData>();
+
+        // a type opts into parallel dispatch with `static constexpr bool parallel = true;`
+        if constexpr (requires { requires T::parallel; })
+        {
+            JobSystem::parallel_for_each(view, 0, [&func, scene](entt::entity, T& behaviour, const GameObjData& data)
+            {
+                if (data.scene == scene) func(behaviour);
+            });
+        }
+        else
+        {
+            for (auto [entity, behaviour, data] : view.each())
+            {
+                if (data.scene == scene) func(behaviour);
+            }
+        }
+    }
+}
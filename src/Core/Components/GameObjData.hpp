@@ -3,10 +3,14 @@
 
 namespace boza
 {
+    class Scene;
+
     struct BOZA_API GameObjData final : Component
     {
         std::string name;
+        // the scene that was active when the object was created
+        const Scene* scene;
 
-        explicit GameObjData(const std::string& name) : name{ name } {}
+        GameObjData(const std::string& name, const Scene* scene) : name{ name }, scene{ scene } {}
     };
 }
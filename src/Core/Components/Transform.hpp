@@ -1,21 +1,59 @@
 #pragma once
 #include "Component.hpp"
 #include "boza_pch.hpp"
+#include "Core/TransformHierarchy.hpp"
 
 namespace boza
 {
+    // Handle to a node of the TransformHierarchy; the data itself lives in the hierarchy's SoA arrays.
     struct BOZA_API Transform final : Component
     {
-        glm::vec3 position;
-        glm::vec3 rotation;
-        glm::vec3 scale;
-
         Transform(
             const glm::vec3& position,
             const glm::vec3& rotation,
             const glm::vec3& scale)
-            : position{ position },
-              rotation{ rotation },
-              scale{ scale } {}
+            : node{ TransformHierarchy::create(position, rotation, scale) } {}
+
+        ~Transform() override
+        {
+            if (node != INVALID_TRANSFORM_NODE) TransformHierarchy::destroy(node);
+        }
+
+        Transform(const Transform&)            = delete;
+        Transform& operator=(const Transform&) = delete;
+
+        Transform(Transform&& other) noexcept
+            : Component{ other },
+              node{ std::exchange(other.node, INVALID_TRANSFORM_NODE) } {}
+
+        Transform& operator=(Transform&& other) noexcept
+        {
+            if (this == &other) return *this;
+            if (node != INVALID_TRANSFORM_NODE) TransformHierarchy::destroy(node);
+
+            Component::operator=(other);
+            node = std::exchange(other.node, INVALID_TRANSFORM_NODE);
+            return *this;
+        }
+
+        [[nodiscard]] glm::vec3 get_position() const { return TransformHierarchy::get_position(node); }
+        [[nodiscard]] glm::vec3 get_rotation() const { return TransformHierarchy::get_rotation(node); }
+        [[nodiscard]] glm::vec3 get_scale() const { return TransformHierarchy::get_scale(node); }
+
+        void set_position(const glm::vec3& position) const { TransformHierarchy::set_position(node, position); }
+        void set_rotation(const glm::vec3& rotation) const { TransformHierarchy::set_rotation(node, rotation); }
+        void set_scale(const glm::vec3& scale) const { TransformHierarchy::set_scale(node, scale); }
+
+        bool set_parent(const Transform* parent) const
+        {
+            return TransformHierarchy::set_parent(node, parent != nullptr ? parent->node : INVALID_TRANSFORM_NODE);
+        }
+
+        // As of the last TransformHierarchy::update().
+        [[nodiscard]] glm::mat4        get_world_matrix() const { return TransformHierarchy::get_world_matrix(node); }
+        [[nodiscard]] transform_node_t get_node() const { return node; }
+
+    private:
+        transform_node_t node;
     };
 }
@@ -0,0 +1,139 @@
+#pragma once
+#include "boza_pch.hpp"
+
+namespace boza
+{
+    class EventQueueBase
+    {
+    public:
+        virtual ~EventQueueBase() = default;
+    };
+
+    // Single-producer single-consumer queue of fixed-size blocks. Drained blocks are handed
+    // back to the producer, so steady-state pushes never allocate.
+    template<typename Event>
+    class EventQueue final : public EventQueueBase
+    {
+    public:
+        EventQueue();
+        ~EventQueue() override;
+
+        EventQueue(const EventQueue&)            = delete;
+        EventQueue(EventQueue&&)                 = delete;
+        EventQueue& operator=(const EventQueue&) = delete;
+        EventQueue& operator=(EventQueue&&)      = delete;
+
+        // producer thread only
+        template<typename... Args>
+        void emplace(Args&&... args);
+
+        // consumer only: appends every published event, then pop() destroys them once handled
+        void peek(std::vector<const void*>& out) const;
+        void pop(size_t count);
+
+    private:
+        static constexpr size_t block_size = 256;
+
+        struct Block
+        {
+            alignas(Event) std::byte storage[block_size * sizeof(Event)];
+            std::atomic_size_t  committed{ 0 };
+            std::atomic<Block*> next{ nullptr };
+            Block*              next_free{ nullptr };
+
+            [[nodiscard]] Event* at(const size_t index) { return std::launder(reinterpret_cast<Event*>(storage) + index); }
+        };
+
+        [[nodiscard]] Block* acquire_block();
+
+        Block* head;
+        size_t head_pos{ 0 };
+
+        alignas(64) Block* tail;
+        size_t tail_pos{ 0 };
+
+        // pushed by the consumer, popped only by the producer, so no ABA
+        alignas(64) std::atomic<Block*> free_blocks{ nullptr };
+    };
+
+
+    template<typename Event>
+    EventQueue<Event>::EventQueue() : head{ new Block }, tail{ head } {}
+
+    template<typename Event>
+    EventQueue<Event>::~EventQueue()
+    {
+        std::vector<const void*> remaining;
+        peek(remaining);
+        pop(remaining.size());
+
+        delete head;
+        for (Block* block = free_blocks.load(); block != nullptr;)
+            delete std::exchange(block, block->next_free);
+    }
+
+    template<typename Event>
+    template<typename... Args>
+    void EventQueue<Event>::emplace(Args&&... args)
+    {
+        if (tail_pos == block_size)
+        {
+            Block* block = acquire_block();
+            tail->next.store(block, std::memory_order_release);
+            tail     = block;
+            tail_pos = 0;
+        }
+
+        new(tail->storage + tail_pos * sizeof(Event)) Event{ std::forward<Args>(args)... };
+        tail->committed.store(++tail_pos, std::memory_order_release);
+    }
+
+    template<typename Event>
+    void EventQueue<Event>::peek(std::vector<const void*>& out) const
+    {
+        size_t pos = head_pos;
+
+        for (Block* block = head; block != nullptr; block = block->next.load(std::memory_order_acquire), pos = 0)
+        {
+            const size_t committed = block->committed.load(std::memory_order_acquire);
+            for (; pos < committed; ++pos)
+                out.push_back(block->at(pos));
+
+            if (committed < block_size) break;
+        }
+    }
+
+    template<typename Event>
+    void EventQueue<Event>::pop(size_t count)
+    {
+        while (count != 0)
+        {
+            if (head_pos == block_size)
+            {
+                Block* next = head->next.load(std::memory_order_acquire);
+                assert(next != nullptr && "Popping more events than were published");
+
+                head->committed.store(0, std::memory_order_relaxed);
+                head->next.store(nullptr, std::memory_order_relaxed);
+
+                head->next_free = free_blocks.load(std::memory_order_relaxed);
+                while (!free_blocks.compare_exchange_weak(head->next_free, head, std::memory_order_release, std::memory_order_relaxed)) {}
+
+                head     = next;
+                head_pos = 0;
+            }
+
+            head->at(head_pos++)->~Event();
+            --count;
+        }
+    }
+
+    template<typename Event>
+    typename EventQueue<Event>::Block* EventQueue<Event>::acquire_block()
+    {
+        Block* block = free_blocks.load(std::memory_order_acquire);
+        while (block != nullptr && !free_blocks.compare_exchange_weak(block, block->next_free, std::memory_order_acquire)) {}
+
+        return block != nullptr ? block : new Block;
+    }
+}
@@ -0,0 +1,39 @@
+#include "EventSystem.hpp"
+
+namespace boza
+{
+    void EventSystem::dispatch_queued()
+    {
+        // a handler calling back in would deadlock on drain_mutex and clobber the batch being delivered
+        thread_local bool draining = false;
+        assert(!draining && "dispatch_queued called from an event handler");
+
+        auto& inst = instance();
+        std::lock_guard drain_lock{ inst.drain_mutex };
+
+        // cleared even if a handler throws, or every later call would trip the assert
+        struct DrainingGuard
+        {
+            bool& draining;
+            ~DrainingGuard() { draining = false; }
+        };
+        draining = true;
+        const DrainingGuard guard{ draining };
+
+        // handlers may enqueue event types that register new queues while we iterate
+        for (size_t i = 0;; ++i)
+        {
+            EventQueueBase* queue;
+            drain_fn        drain;
+            {
+                std::lock_guard lock{ inst.queues_mutex };
+                if (i >= inst.queues.size()) break;
+
+                queue = inst.queues[i].queue.get();
+                drain = inst.queues[i].drain;
+            }
+
+            drain(*queue);
+        }
+    }
+}
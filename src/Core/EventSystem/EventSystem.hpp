@@ -1,9 +1,12 @@
 #pragma once
 #include "boza_pch.hpp"
 #include "Singleton.hpp"
+#include "EventQueue.hpp"
 
 namespace boza
 {
+    // Handlers run outside the lock on a snapshot of the subscribers, so they may trigger, enqueue, subscribe or
+    // unsubscribe; one unsubscribed while an event is being delivered may still receive that event.
     class BOZA_API EventSystem final : public Singleton<EventSystem>
     {
     public:
@@ -19,11 +22,56 @@ namespace boza
         template<typename Event>
         static void trigger(const Event& event);
 
+        // Callback runs on job workers, concurrently with itself, for events delivered by dispatch_queued().
+        template<typename Event, auto Callback>
+        static void subscribe_parallel();
+
+        // Lock-free and allocation-free in the steady state; delivered at the next dispatch_queued().
+        template<typename Event, typename... Args>
+        static void enqueue(Args&&... args);
+
+        // Sync point: delivers everything enqueued so far, in per-thread order. Not re-entrant, so handlers must
+        // not call it.
+        static void dispatch_queued();
+
     private:
-        std::unordered_map<std::type_index, std::vector<entt::connection>> connections;
+        using drain_fn         = void(*)(EventQueueBase&);
+        using sync_handler     = entt::delegate<void(const void*)>;
+        using parallel_handler = void(*)(const void*);
+
+        struct QueueEntry
+        {
+            std::unique_ptr<EventQueueBase> queue;
+            drain_fn                        drain;
+        };
+
+        template<typename Event>
+        static EventQueue<Event>& local_queue();
+
+        template<typename Event>
+        static void drain_queue(EventQueueBase& base);
+
+        template<typename Event, auto Callback>
+        static void invoke(const void* event);
+        template<typename Event, typename T, auto Callback>
+        static void invoke_member(T& receiver, const void* event);
+
+        // Takes the lock.
+        template<typename Event>
+        static void copy_handlers(std::vector<sync_handler>& sync, std::vector<parallel_handler>* parallel);
+
+        std::unordered_map<std::type_index, std::vector<sync_handler>>     sync_handlers;
+        std::unordered_map<std::type_index, std::vector<parallel_handler>> parallel_handlers;
+        std::mutex                                                         mutex;
+
+        std::vector<QueueEntry> queues;
+        std::mutex              queues_mutex;
 
-        entt::dispatcher dispatcher;
-        std::mutex       mutex;
+        // consumer side of the queues; producers never touch it
+        std::mutex                    drain_mutex;
+        std::vector<const void*>      batch;
+        std::vector<sync_handler>     batch_sync_handlers;
+        std::vector<parallel_handler> batch_parallel_handlers;
 
         friend Singleton;
         EventSystem() = default;
@@ -1,5 +1,6 @@
 #pragma once
 #include "EventSystem.hpp"
+#include "Core/JobSystem/JobSystem.hpp"
 
 namespace boza
 {
@@ -8,42 +9,148 @@ namespace boza
     {
         auto& inst = instance();
 
+        sync_handler handler;
+        handler.template connect<&invoke<Event, Callback>>();
+
         std::lock_guard lock{ inst.mutex };
-        auto conn = inst.dispatcher.sink<Event>().template connect<Callback>();
-        inst.connections[std::type_index(typeid(Event))].push_back(conn);
+        inst.sync_handlers[std::type_index(typeid(Event))].push_back(handler);
     }
 
     template<typename Event, typename T, auto Callback>
-    void EventSystem::subscribe(T* instance)
+    void EventSystem::subscribe(T* receiver)
     {
         auto& inst = instance();
 
+        sync_handler handler;
+        handler.template connect<&invoke_member<Event, T, Callback>>(*receiver);
+
         std::lock_guard lock{ inst.mutex };
-        auto conn = inst.dispatcher.template sink<Event>().connect<Callback>(instance);
-        inst.connections[std::type_index(typeid(Event))].push_back(conn);
+        inst.sync_handlers[std::type_index(typeid(Event))].push_back(handler);
     }
 
     template<typename Event>
-   void EventSystem::unsubscribe()
+    void EventSystem::unsubscribe()
+    {
+        auto& inst = instance();
+
+        std::lock_guard lock{ inst.mutex };
+        inst.sync_handlers.erase(std::type_index(typeid(Event)));
+        inst.parallel_handlers.erase(std::type_index(typeid(Event)));
+    }
+
+    template<typename Event>
+    void EventSystem::trigger(const Event& event)
+    {
+        // one scratch list per nesting level, since a handler may trigger again; a deque keeps outer levels in place
+        thread_local std::deque<std::vector<sync_handler>> scratch;
+        thread_local size_t                                depth = 0;
+
+        if (depth == scratch.size()) scratch.emplace_back();
+        auto& handlers = scratch[depth];
+
+        struct DepthGuard
+        {
+            size_t& depth;
+            ~DepthGuard() { --depth; }
+        };
+        ++depth;
+        const DepthGuard guard{ depth };
+
+        copy_handlers<Event>(handlers, nullptr);
+
+        for (const auto& handler : handlers)
+            handler(&event);
+    }
+
+    template<typename Event, auto Callback>
+    void EventSystem::subscribe_parallel()
     {
         auto& inst = instance();
 
         std::lock_guard lock{ inst.mutex };
+        inst.parallel_handlers[std::type_index(typeid(Event))].push_back(
+            [](const void* event) { std::invoke(Callback, *static_cast<const Event*>(event)); });
+    }
+
+    template<typename Event, typename... Args>
+    void EventSystem::enqueue(Args&&... args)
+    {
+        local_queue<Event>().emplace(std::forward<Args>(args)...);
+    }
+
+    template<typename Event>
+    EventQueue<Event>& EventSystem::local_queue()
+    {
+        thread_local EventQueue<Event>* queue = nullptr;
+        if (queue != nullptr) return *queue;
 
-        if (const auto it = inst.connections.find(std::type_index(typeid(Event)));
-            it != inst.connections.end())
+        auto& inst  = instance();
+        auto  owned = std::make_unique<EventQueue<Event>>();
+        queue       = owned.get();
+
+        std::lock_guard lock{ inst.queues_mutex };
+        inst.queues.push_back({ std::move(owned), &drain_queue<Event> });
+
+        return *queue;
+    }
+
+    template<typename Event>
+    void EventSystem::drain_queue(EventQueueBase& base)
+    {
+        auto& inst  = instance();
+        auto& queue = static_cast<EventQueue<Event>&>(base);
+
+        inst.batch.clear();
+        queue.peek(inst.batch);
+        if (inst.batch.empty()) return;
+
+        copy_handlers<Event>(inst.batch_sync_handlers, &inst.batch_parallel_handlers);
+
+        for (const void* event : inst.batch)
+        {
+            for (const auto& handler : inst.batch_sync_handlers)
+                handler(event);
+        }
+
+        if (!inst.batch_parallel_handlers.empty())
         {
-            for (auto& conn : it->second) conn.release();
-            inst.connections.erase(it);
+            JobSystem::parallel_for<size_t>(0, inst.batch.size(), 0, [&inst](const size_t i)
+            {
+                for (const auto handler : inst.batch_parallel_handlers)
+                    handler(inst.batch[i]);
+            });
         }
+
+        queue.pop(inst.batch.size());
+    }
+
+
+    template<typename Event, auto Callback>
+    void EventSystem::invoke(const void* event)
+    {
+        std::invoke(Callback, *static_cast<const Event*>(event));
+    }
+
+    template<typename Event, typename T, auto Callback>
+    void EventSystem::invoke_member(T& receiver, const void* event)
+    {
+        std::invoke(Callback, receiver, *static_cast<const Event*>(event));
     }
 
     template<typename Event>
-    void EventSystem::trigger(const Event& event)
+    void EventSystem::copy_handlers(std::vector<sync_handler>& sync, std::vector<parallel_handler>* parallel)
     {
         auto& inst = instance();
+        const std::type_index type{ typeid(Event) };
 
         std::lock_guard lock{ inst.mutex };
-        inst.dispatcher.trigger(event);
+
+        if (const auto it = inst.sync_handlers.find(type); it != inst.sync_handlers.end()) sync.assign(it->second.begin(), it->second.end());
+        else sync.clear();
+
+        if (parallel == nullptr) return;
+
+        if (const auto it = inst.parallel_handlers.find(type); it != inst.parallel_handlers.end()) parallel->assign(it->second.begin(), it->second.end());
+        else parallel->clear();
     }
 }
@@ -6,7 +6,7 @@ namespace boza
     {
         Scene::push_game_object(this);
 
-        data      = &add_component<GameObjData>(name);
+        data      = &add_component<GameObjData>(name, Scene::active_scene());
         transform = &add_component<Transform>(
             glm::vec3{ 0.0 },
             glm::vec3{ 0.0 },
@@ -33,15 +33,10 @@ namespace boza
         template<component_derived... Ts> [[nodiscard]] bool has_components() const;
 
     private:
-        friend class PhysicsSystem;
-        friend class RenderingSystem;
-
         entt::entity entity;
 
         GameObjData* data{ nullptr };
         Transform*   transform{ nullptr };
-
-        hash_set<Behaviour*> behaviours{};
     };
 }
 
@@ -1,6 +1,7 @@
 #pragma once
 #include "GameObject.hpp"
 #include "Scene.hpp"
+#include "BehaviourDispatcher.hpp"
 
 namespace boza
 {
@@ -13,7 +14,7 @@ namespace boza
         if constexpr (behaviour_derived<T>)
         {
             reinterpret_cast<Behaviour*>(&component)->transform = transform;
-            behaviours.emplace(&component);
+            BehaviourDispatcher::register_type<T>();
         }
 
         return component;
@@ -0,0 +1,74 @@
+#pragma once
+#include "boza_pch.hpp"
+
+namespace boza
+{
+    class Job final
+    {
+    public:
+        static constexpr std::size_t inline_capacity = 64;
+
+        Job() = default;
+        ~Job() { reset(); }
+
+        Job(const Job&)            = delete;
+        Job(Job&&)                 = delete;
+        Job& operator=(const Job&) = delete;
+        Job& operator=(Job&&)      = delete;
+
+        template<typename F>
+        void emplace(F&& func);
+        void reset();
+
+        void operator()();
+        [[nodiscard]] bool empty() const;
+
+    private:
+        template<typename F>
+        static constexpr bool stored_inline =
+            sizeof(F) <= inline_capacity &&
+            alignof(F) <= alignof(std::max_align_t) &&
+            std::is_nothrow_move_constructible_v<F>;
+
+        alignas(std::max_align_t) std::byte storage[inline_capacity]{};
+
+        void (*invoke_fn)(void*){ nullptr };
+        void (*destroy_fn)(void*){ nullptr };
+    };
+
+
+    template<typename F>
+    void Job::emplace(F&& func)
+    {
+        using Fn = std::decay_t<F>;
+        reset();
+
+        if constexpr (stored_inline<Fn>)
+        {
+            ::new (static_cast<void*>(storage)) Fn(std::forward<F>(func));
+            invoke_fn  = [](void* ptr) { (*static_cast<Fn*>(ptr))(); };
+            destroy_fn = [](void* ptr) { static_cast<Fn*>(ptr)->~Fn(); };
+        }
+        else
+        {
+            ::new (static_cast<void*>(storage)) Fn*(new Fn(std::forward<F>(func)));
+            invoke_fn  = [](void* ptr) { (**static_cast<Fn**>(ptr))(); };
+            destroy_fn = [](void* ptr) { delete *static_cast<Fn**>(ptr); };
+        }
+    }
+
+    inline void Job::reset()
+    {
+        if (destroy_fn != nullptr) destroy_fn(storage);
+        invoke_fn  = nullptr;
+        destroy_fn = nullptr;
+    }
+
+    inline void Job::operator()()
+    {
+        assert(invoke_fn != nullptr && "Invoking an empty job");
+        invoke_fn(storage);
+    }
+
+    inline bool Job::empty() const { return invoke_fn == nullptr; }
+}
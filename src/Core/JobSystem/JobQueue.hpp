@@ -0,0 +1,90 @@
+#pragma once
+#include "boza_pch.hpp"
+
+namespace boza
+{
+    // Bounded multi-producer multi-consumer FIFO of slot indices (Vyukov).
+    class JobQueue final
+    {
+    public:
+        explicit JobQueue(size_t capacity);
+
+        JobQueue(const JobQueue&)            = delete;
+        JobQueue(JobQueue&&)                 = delete;
+        JobQueue& operator=(const JobQueue&) = delete;
+        JobQueue& operator=(JobQueue&&)      = delete;
+
+        bool push(uint32_t value);
+        [[nodiscard]] std::optional<uint32_t> pop();
+
+    private:
+        struct Cell
+        {
+            std::atomic_size_t sequence;
+            uint32_t           value;
+        };
+
+        std::unique_ptr<Cell[]> cells;
+        size_t                  mask;
+
+        alignas(64) std::atomic_size_t enqueue_pos{ 0 };
+        alignas(64) std::atomic_size_t dequeue_pos{ 0 };
+    };
+
+
+    inline JobQueue::JobQueue(const size_t capacity)
+        : cells{ std::make_unique<Cell[]>(std::bit_ceil(capacity)) },
+          mask{ std::bit_ceil(capacity) - 1 }
+    {
+        for (size_t i = 0; i <= mask; ++i)
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    inline bool JobQueue::push(const uint32_t value)
+    {
+        Cell*  cell;
+        size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+
+        while (true)
+        {
+            cell = &cells[pos & mask];
+            const size_t    sequence   = cell->sequence.load(std::memory_order_acquire);
+            const ptrdiff_t difference = static_cast<ptrdiff_t>(sequence) - static_cast<ptrdiff_t>(pos);
+
+            if (difference == 0)
+            {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            }
+            else if (difference < 0) return false;
+            else pos = enqueue_pos.load(std::memory_order_relaxed);
+        }
+
+        cell->value = value;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    inline std::optional<uint32_t> JobQueue::pop()
+    {
+        Cell*  cell;
+        size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+
+        while (true)
+        {
+            cell = &cells[pos & mask];
+            const size_t    sequence   = cell->sequence.load(std::memory_order_acquire);
+            const ptrdiff_t difference = static_cast<ptrdiff_t>(sequence) - static_cast<ptrdiff_t>(pos + 1);
+
+            if (difference == 0)
+            {
+                if (dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            }
+            else if (difference < 0) return std::nullopt;
+            else pos = dequeue_pos.load(std::memory_order_relaxed);
+        }
+
+        const uint32_t value = cell->value;
+        cell->sequence.store(pos + mask + 1, std::memory_order_release);
+        return value;
+    }
+}
@@ -2,6 +2,14 @@
 
 namespace boza
 {
+    JobSystem::~JobSystem()
+    {
+        background_executor.wait_for_all();
+        executor.wait_for_all();
+        for (auto& chunk : chunks)
+            delete[] chunk.exchange(nullptr);
+    }
+
     void JobSystem::start()
     {
         instance();
@@ -10,137 +18,387 @@ namespace boza
     void JobSystem::stop()
     {
         auto& inst = instance();
+        inst.background_executor.wait_for_all();
         inst.executor.wait_for_all();
+    }
 
-        std::lock_guard lock{ inst.mutex };
-        for (const auto& task_data : std::views::values(inst.tasks))
-            task_data->canceled.store(true);
-        inst.tasks.clear();
+    void JobSystem::begin_frame()
+    {
+        instance().current_frame.fetch_add(1, std::memory_order_release);
+        BOZA_PROFILE_COUNTER("Jobs in flight", instance().jobs_in_flight.load(std::memory_order_relaxed));
+    }
+
+    uint64_t JobSystem::get_current_frame()
+    {
+        return instance().current_frame.load(std::memory_order_acquire);
     }
 
-    JobSystem::task_id JobSystem::push_task(const std::function<void()>& func)
+    bool JobSystem::cancel_task(const task_id id)
     {
         auto& inst = instance();
-        task_id id = inst.next_task_id.fetch_add(1);
 
-        auto task_data = std::make_shared<TaskData>();
+        TaskSlot* slot = inst.find_slot(id);
+        if (slot == nullptr) return false;
+
+        const auto index      = static_cast<uint32_t>(id);
+        const auto generation = static_cast<uint32_t>(id >> 32);
+        uint64_t   expected   = pack_state(generation, TaskState::Pending);
 
-        task_data->func     = func;
-        task_data->taskflow = std::make_shared<tf::Taskflow>();
+        if (!slot->state.compare_exchange_strong(expected, pack_state(generation, TaskState::Running), std::memory_order_acq_rel))
+            return false;
+
+        inst.finish(index, generation, TaskState::Canceled);
+        return true;
+    }
 
-        task_data->taskflow->emplace([task_data, id, &inst]
+    JobError JobSystem::wait_for_task(const task_id id)
+    {
+        auto& inst = instance();
+
+        TaskSlot* slot = inst.find_slot(id);
+        if (slot == nullptr) return JobError::TaskNotFound;
+
+        const auto index      = static_cast<uint32_t>(id);
+        const auto generation = static_cast<uint32_t>(id >> 32);
+
+        inst.try_run(index, generation);
+
+        uint64_t   value = slot->state.load(std::memory_order_acquire);
+        const auto done  = [&]
         {
-            if (task_data->canceled.load()) return;
+            return generation_of(value) != generation || is_final(state_of(value));
+        };
 
-            try
+        if (tf::Executor& executor = inst.current_executor(); executor.this_worker_id() >= 0)
+        {
+            executor.corun_until([&]
+            {
+                value = slot->state.load(std::memory_order_acquire);
+                return done();
+            });
+        }
+        else
+        {
+            while (!done())
             {
-                task_data->func();
-                task_data->completed.store(true);
+                slot->state.wait(value, std::memory_order_acquire);
+                value = slot->state.load(std::memory_order_acquire);
             }
-            catch (...) { task_data->failed.store(true); }
+        }
 
-            std::lock_guard cleanup_lock{ inst.mutex };
-            inst.tasks.erase(id);
-        });
+        if (generation_of(value) != generation) return recycled_result(*slot, generation);
+        return *to_result(state_of(value));
+    }
 
-        {
-            std::lock_guard lock{ inst.mutex };
-            inst.tasks[id] = task_data;
-        }
 
-        inst.executor.run(*task_data->taskflow).get();
-        return id;
+    JobError JobSystem::execute_task(const std::function<void()>& func)
+    {
+        return execute_batch({ func });
     }
 
-    bool JobSystem::cancel_task(const task_id id)
+    JobError JobSystem::execute_batch(const std::vector<std::function<void()>>& funcs)
     {
-        auto& inst = instance();
-        std::shared_ptr<TaskData> task_data;
+        TaskGraph graph;
+        for (const auto& func : funcs)
+            graph.emplace([&func] { func(); });
+
+        return execute_graph(graph);
+    }
+
+
+    std::future<void> JobSystem::run_graph(TaskGraph& graph)
+    {
+        graph.reset_failure();
+        return instance().executor.run(graph.taskflow);
+    }
+
+    JobError JobSystem::execute_graph(TaskGraph& graph)
+    {
+        graph.reset_failure();
+        instance().run_and_wait(graph.taskflow);
+        return graph.has_failed() ? JobError::TaskFailed : JobError::Success;
+    }
+
+
+    std::optional<JobError> JobSystem::is_task_completed(const task_id id)
+    {
+        const auto& inst = instance();
+
+        const TaskSlot* slot = inst.find_slot(id);
+        if (slot == nullptr) return std::nullopt;
+
+        const auto     generation = static_cast<uint32_t>(id >> 32);
+        const uint64_t value      = slot->state.load(std::memory_order_acquire);
+        if (generation_of(value) != generation) return recycled_result(*slot, generation);
+
+        return to_result(state_of(value));
+    }
+
+
+    uint32_t JobSystem::acquire_slot()
+    {
+        uint64_t head = free_head.load(std::memory_order_acquire);
 
+        while (static_cast<uint32_t>(head) != INVALID_SLOT)
         {
-            std::lock_guard lock{ inst.mutex };
+            const auto     index    = static_cast<uint32_t>(head);
+            const uint32_t next     = get_slot(index).next_free.load(std::memory_order_relaxed);
+            const uint64_t new_head = ((head >> 32) + 1) << 32 | next;
 
-            const auto it = inst.tasks.find(id);
+            if (free_head.compare_exchange_weak(head, new_head, std::memory_order_acq_rel, std::memory_order_acquire))
+                return index;
+        }
+
+        const uint32_t index = next_unused_slot.fetch_add(1, std::memory_order_relaxed);
+        if (index >= slots_per_chunk * max_chunks) return INVALID_SLOT;
+
+        if (auto& chunk = chunks[index / slots_per_chunk];
+            chunk.load(std::memory_order_acquire) == nullptr)
+        {
+            auto*     fresh    = new TaskSlot[slots_per_chunk];
+            TaskSlot* expected = nullptr;
 
-            if (it == inst.tasks.end()) return false;
-            task_data = it->second;
+            if (!chunk.compare_exchange_strong(expected, fresh, std::memory_order_acq_rel))
+                delete[] fresh;
         }
 
-        task_data->canceled.store(true);
-        return true;
+        return index;
     }
 
-    JobError JobSystem::wait_for_task(const task_id id)
+    void JobSystem::release_slot(const uint32_t index)
     {
-        auto& inst = instance();
-        std::shared_ptr<TaskData> task_data;
+        TaskSlot& slot = get_slot(index);
+        uint64_t  head = free_head.load(std::memory_order_relaxed);
 
+        do
         {
-            std::lock_guard lock{ inst.mutex };
+            slot.next_free.store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+        }
+        while (!free_head.compare_exchange_weak(
+            head, ((head >> 32) + 1) << 32 | index,
+            std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    JobSystem::TaskSlot& JobSystem::get_slot(const uint32_t index) const
+    {
+        return chunks[index / slots_per_chunk].load(std::memory_order_acquire)[index % slots_per_chunk];
+    }
+
+    JobSystem::TaskSlot* JobSystem::find_slot(const task_id id) const
+    {
+        const auto index = static_cast<uint32_t>(id);
+        if (index >= std::min(next_unused_slot.load(std::memory_order_acquire), slots_per_chunk * max_chunks)) return nullptr;
+
+        TaskSlot* chunk = chunks[index / slots_per_chunk].load(std::memory_order_acquire);
+        return chunk != nullptr ? &chunk[index % slots_per_chunk] : nullptr;
+    }
+
+
+    JobSystem::task_id JobSystem::submit(const uint32_t index, const JobPriority priority)
+    {
+        TaskSlot&      slot       = get_slot(index);
+        const uint64_t previous   = slot.state.load(std::memory_order_relaxed);
+        const uint32_t generation = generation_of(previous) + 1;
+
+        // published by the release store of the new state below
+        slot.previous.store(previous, std::memory_order_relaxed);
+        slot.refs.store(2, std::memory_order_relaxed);
+        slot.state.store(pack_state(generation, TaskState::Pending), std::memory_order_release);
+        BOZA_PROFILE_ONLY(jobs_in_flight.fetch_add(1, std::memory_order_relaxed);)
+
+        // cannot overflow: a lane never holds more entries than there are slots
+        lanes[static_cast<size_t>(priority)].push(index);
+
+        if (priority == JobPriority::Background) background_executor.silent_async([this] { drain(true); });
+        else executor.silent_async([this] { drain(false); });
 
-            const auto it = inst.tasks.find(id);
+        return static_cast<task_id>(generation) << 32 | index;
+    }
+
+    void JobSystem::drain(const bool background)
+    {
+        std::optional<uint32_t> index;
+
+        if (background) index = lanes[static_cast<size_t>(JobPriority::Background)].pop();
+        else if (!((index = lanes[static_cast<size_t>(JobPriority::FrameCritical)].pop())))
+            index = lanes[static_cast<size_t>(JobPriority::Normal)].pop();
 
-            if (it == inst.tasks.end()) return JobError::TaskNotFound;
-            task_data = it->second;
+        if (!index) return;
+
+        // the lane entry holds a reference, so the generation cannot move on underneath us
+        try_run(*index, generation_of(get_slot(*index).state.load(std::memory_order_acquire)));
+        release_ref(*index);
+    }
+
+    bool JobSystem::try_run(const uint32_t index, const uint32_t generation)
+    {
+        TaskSlot& slot     = get_slot(index);
+        uint64_t  expected = pack_state(generation, TaskState::Pending);
+
+        if (!slot.state.compare_exchange_strong(expected, pack_state(generation, TaskState::Running), std::memory_order_acq_rel))
+            return false;
+
+        auto result = TaskState::Completed;
+
+        if (slot.deadline_frame < current_frame.load(std::memory_order_acquire)) result = TaskState::Expired;
+        else
+        {
+            BOZA_PROFILE_ZONE("Job");
+
+            try { slot.job(); }
+            catch (...) { result = TaskState::Failed; }
         }
 
-        while (
-            !task_data->completed.load() &&
-            !task_data->canceled.load() &&
-            !task_data->failed.load())
-            std::this_thread::yield();
+        finish(index, generation, result);
+        return true;
+    }
+
+    void JobSystem::finish(const uint32_t index, const uint32_t generation, const TaskState state)
+    {
+        TaskSlot& slot = get_slot(index);
+
+        slot.state.store(pack_state(generation, state), std::memory_order_release);
+        slot.state.notify_all();
+        BOZA_PROFILE_ONLY(jobs_in_flight.fetch_sub(1, std::memory_order_relaxed);)
 
-        if (task_data->canceled.load()) return JobError::TaskCanceled;
-        if (task_data->failed.load()) return JobError::TaskFailed;
+        release_ref(index);
+    }
 
-        return JobError::Success;
+    void JobSystem::release_ref(const uint32_t index)
+    {
+        if (TaskSlot& slot = get_slot(index);
+            slot.refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            slot.job.reset();
+            release_slot(index);
+        }
     }
 
 
-    JobError JobSystem::execute_task(const std::function<void()>& func)
+    tf::Executor& JobSystem::current_executor()
     {
-        return wait_for_task(push_task(func));
+        return background_executor.this_worker_id() >= 0 ? background_executor : executor;
     }
 
-    JobError JobSystem::execute_batch(const std::vector<std::function<void()>>& funcs)
+    void JobSystem::run_and_wait(tf::Taskflow& taskflow)
     {
-        std::vector<task_id> ids;
-        ids.reserve(funcs.size());
-        auto firstError = JobError::Success;
+        tf::Executor& current = current_executor();
 
-        for (const auto& func : funcs)
-            ids.push_back(push_task(func));
+        if (current.this_worker_id() >= 0) current.corun(taskflow);
+        else current.run(taskflow).wait();
+    }
 
-        for (const auto& id : ids)
+    void JobSystem::wait_for_zero(std::atomic_size_t& counter)
+    {
+        if (tf::Executor& current = current_executor(); current.this_worker_id() >= 0)
         {
-            if (const JobError result = wait_for_task(id);
-                result != JobError::Success && firstError == JobError::Success)
-                firstError = result;
+            current.corun_until([&counter] { return counter.load(std::memory_order_acquire) == 0; });
+            return;
         }
 
-        return firstError;
+        for (size_t value; (value = counter.load(std::memory_order_acquire)) != 0;)
+            counter.wait(value, std::memory_order_acquire);
     }
 
 
-    std::optional<JobError> JobSystem::is_task_completed(const task_id id)
+    size_t JobSystem::max_participants() { return current_executor().num_workers() + 1; }
+
+    JobError JobSystem::run_chunked(
+        const size_t count,
+        const size_t grain,
+        const std::function<void(size_t, size_t, size_t)>& body)
     {
-        auto& inst = instance();
+        if (count == 0) return JobError::Success;
 
-        std::shared_ptr<TaskData> task_data;
+        const size_t max_count    = max_participants();
+        const size_t min_chunk    = grain != 0 ? grain : std::max<size_t>(1, count / (max_count * 32));
+        const size_t participants = std::min(max_count, (count + min_chunk - 1) / min_chunk);
 
+        struct State
         {
-            std::lock_guard lock{ inst.mutex };
+            const std::function<void(size_t, size_t, size_t)>* body;
+            size_t               count;
+            size_t               min_chunk;
+            size_t               participants;
+            std::atomic_size_t   cursor{ 0 };
+            // items not yet finished; only claimed chunks are waited for, so helpers that never start cannot stall us
+            std::atomic_size_t   remaining{ 0 };
+            std::atomic_bool     failed{ false };
+        };
+
+        // late helpers still touch the state after we return, but never body: the cursor is exhausted by then
+        const auto state = std::make_shared<State>(&body, count, min_chunk, participants);
+        state->remaining.store(count, std::memory_order_relaxed);
+
+        const auto work = [](State& st, const size_t participant)
+        {
+            const auto retire = [&st](const size_t items)
+            {
+                if (items != 0 && st.remaining.fetch_sub(items, std::memory_order_acq_rel) == items)
+                    st.remaining.notify_all();
+            };
+
+            while (st.cursor.load(std::memory_order_relaxed) < st.count)
+            {
+                const size_t remaining = st.count - std::min(st.count, st.cursor.load(std::memory_order_relaxed));
+                const size_t chunk     = std::max(st.min_chunk, remaining / (2 * st.participants));
+                const size_t first     = st.cursor.fetch_add(chunk, std::memory_order_relaxed);
+                if (first >= st.count) break;
+
+                const size_t last = std::min(first + chunk, st.count);
+
+                try
+                {
+                    BOZA_PROFILE_ZONE("Parallel chunk");
+                    (*st.body)(first, last, participant);
+                }
+                catch (...)
+                {
+                    st.failed.store(true);
+
+                    // nobody will claim what is left, so retire it on their behalf
+                    const size_t claimed = st.cursor.exchange(st.count);
+                    retire(st.count - std::min(st.count, claimed));
+                }
+
+                retire(last - first);
+            }
+        };
+
+        tf::Executor& current = current_executor();
+        for (size_t participant = 1; participant < participants; ++participant)
+            current.silent_async([state, work, participant] { work(*state, participant); });
 
-            const auto it = inst.tasks.find(id);
+        work(*state, 0);
+        wait_for_zero(state->remaining);
+
+        return state->failed.load() ? JobError::TaskFailed : JobError::Success;
+    }
 
-            if (it == inst.tasks.end()) return std::nullopt;
-            task_data = it->second;
+    std::optional<JobError> JobSystem::to_result(const TaskState state)
+    {
+        switch (state)
+        {
+            case TaskState::Completed: return JobError::Success;
+            case TaskState::Canceled: return JobError::TaskCanceled;
+            case TaskState::Failed: return JobError::TaskFailed;
+            case TaskState::Expired: return JobError::DeadlineMissed;
+            default: return std::nullopt;
         }
+    }
 
-        if (task_data->completed.load()) return JobError::Success;
-        if (task_data->canceled.load()) return JobError::TaskCanceled;
-        if (task_data->failed.load()) return JobError::TaskFailed;
+    JobError JobSystem::recycled_result(const TaskSlot& slot, const uint32_t generation)
+    {
+        // the slot went through yet another task meanwhile; the outcome is lost, but the task did finish
+        const uint64_t previous = slot.previous.load(std::memory_order_relaxed);
+        if (generation_of(previous) != generation) return JobError::Success;
 
-        return std::nullopt;
+        return to_result(state_of(previous)).value_or(JobError::Success);
+    }
+
+    bool JobSystem::is_final(const TaskState state)
+    {
+        return state == TaskState::Completed || state == TaskState::Canceled || state == TaskState::Failed
+            || state == TaskState::Expired;
     }
 }
@@ -1,6 +1,10 @@
 #pragma once
 #include "boza_pch.hpp"
 #include "Singleton.hpp"
+#include "Profiler.hpp"
+#include "Job.hpp"
+#include "JobQueue.hpp"
+#include "TaskGraph.hpp"
 
 namespace boza
 {
@@ -10,44 +14,153 @@ namespace boza
         TaskCanceled,
         TaskFailed,
         TaskNotFound,
-        SystemShutdown
+        SystemShutdown,
+        DeadlineMissed
+    };
+
+    enum class JobPriority : uint8_t
+    {
+        FrameCritical,
+        Normal,
+        Background
+    };
+
+    struct JobOptions
+    {
+        static constexpr uint64_t NO_DEADLINE = std::numeric_limits<uint64_t>::max();
+
+        JobPriority priority{ JobPriority::Normal };
+        // last frame (see JobSystem::get_current_frame) in which the job may still start
+        uint64_t deadline_frame{ NO_DEADLINE };
     };
 
     class BOZA_API JobSystem final : public Singleton<JobSystem>
     {
     public:
         using task_id = uint64_t;
+        static constexpr task_id INVALID_TASK_ID = std::numeric_limits<task_id>::max();
 
         static void start();
         static void stop();
 
-        static task_id push_task(const std::function<void()>& func);
+        // Called once per rendered frame; jobs whose deadline lies behind the current frame are dropped.
+        static void     begin_frame();
+        static uint64_t get_current_frame();
+
+        // Returns immediately. Once the slot has been recycled, waiting on or polling the id still reports the
+        // task's outcome while the slot is on its next task, and Success after that.
+        // Background jobs run on their own workers and never occupy the ones serving frame work. Nested parallel_for
+        // and execute_graph calls stay on the pool of the job that makes them.
+        template<typename F> requires std::invocable<std::decay_t<F>&>
+        static task_id push_task(F&& func, const JobOptions& options = {});
         static bool cancel_task(task_id id);
         static JobError wait_for_task(task_id id);
 
         static JobError execute_task(const std::function<void()>& func);
         static JobError execute_batch(const std::vector<std::function<void()>>& funcs);
 
+        // A graph can be re-run as often as needed, but not while a previous run is still in flight.
+        static std::future<void> run_graph(TaskGraph& graph);
+        static JobError          execute_graph(TaskGraph& graph);
+
         static std::optional<JobError> is_task_completed(task_id id);
 
+        // grain == 0 lets the scheduler pick chunk sizes; idle participants keep claiming shrinking chunks.
+        template<std::integral I, typename F> requires std::invocable<F&, I>
+        static JobError parallel_for(I begin, I end, I grain, F&& func);
+
+        // identity is folded in once, so it need not be neutral; reduce must be associative and commutative.
+        template<std::integral I, typename T, typename Map, typename Reduce>
+        static std::expected<T, JobError> parallel_reduce(I begin, I end, I grain, T identity, Map&& map, Reduce&& reduce);
+
+        // Splits an entt view by position in its leading storage and calls func(entity, components&...).
+        template<typename View, typename F>
+        static JobError parallel_for_each(const View& view, size_t grain, F&& func);
+
     private:
-        struct TaskData
+        enum class TaskState : uint32_t
+        {
+            Pending,
+            Running,
+            Completed,
+            Canceled,
+            Failed,
+            Expired
+        };
+
+        static constexpr uint32_t INVALID_SLOT    = std::numeric_limits<uint32_t>::max();
+        static constexpr uint32_t slots_per_chunk = 1024;
+        static constexpr uint32_t max_chunks      = 256;
+        static constexpr size_t   lane_count      = static_cast<size_t>(JobPriority::Background) + 1;
+
+        struct TaskSlot
         {
-            std::function<void()> func;
+            // generation in the high half, TaskState in the low half
+            std::atomic_uint64_t state{ 0 };
+            // final state of the previous generation, kept so a recycled id can still be answered
+            std::atomic_uint64_t previous{ 0 };
+            // held by the scheduled executor callback and by whoever moves the task to a final state
+            std::atomic_uint32_t refs{ 0 };
+            std::atomic_uint32_t next_free{ INVALID_SLOT };
+            uint64_t             deadline_frame{ JobOptions::NO_DEADLINE };
+            Job                  job;
+        };
+
+        [[nodiscard]] uint32_t acquire_slot();
+        void                   release_slot(uint32_t index);
+        [[nodiscard]] TaskSlot& get_slot(uint32_t index) const;
+        [[nodiscard]] TaskSlot* find_slot(task_id id) const;
+
+        [[nodiscard]] task_id submit(uint32_t index, JobPriority priority);
+        void                  drain(bool background);
+        bool                  try_run(uint32_t index, uint32_t generation);
+        void                  finish(uint32_t index, uint32_t generation, TaskState state);
+        void                  release_ref(uint32_t index);
+
+        // The executor the calling thread works for, so nested waits help their own pool; the frame one otherwise.
+        [[nodiscard]] tf::Executor& current_executor();
 
-            std::atomic_bool completed{ false };
-            std::atomic_bool canceled{ false };
-            std::atomic_bool failed{ false };
+        void run_and_wait(tf::Taskflow& taskflow);
+        void wait_for_zero(std::atomic_size_t& counter);
 
-            std::shared_ptr<tf::Taskflow> taskflow;
+        [[nodiscard]] size_t   max_participants();
+        [[nodiscard]] JobError run_chunked(size_t count, size_t grain, const std::function<void(size_t, size_t, size_t)>& body);
+
+        [[nodiscard]] static constexpr uint64_t  pack_state(const uint32_t generation, const TaskState state) { return static_cast<uint64_t>(generation) << 32 | static_cast<uint32_t>(state); }
+        [[nodiscard]] static constexpr uint32_t  generation_of(const uint64_t value) { return static_cast<uint32_t>(value >> 32); }
+        [[nodiscard]] static constexpr TaskState state_of(const uint64_t value) { return static_cast<TaskState>(static_cast<uint32_t>(value)); }
+        [[nodiscard]] static std::optional<JobError> to_result(TaskState state);
+        // for a generation older than the one the slot holds now
+        [[nodiscard]] static JobError                recycled_result(const TaskSlot& slot, uint32_t generation);
+        [[nodiscard]] static bool                    is_final(TaskState state);
+
+        // the two pools split the hardware threads between them rather than oversubscribing it
+        [[nodiscard]] static uint32_t hardware_threads() { return std::max(2u, std::thread::hardware_concurrency()); }
+        [[nodiscard]] static uint32_t background_threads() { return std::max(1u, hardware_threads() / 4); }
+
+        tf::Executor executor{ hardware_threads() - background_threads() };
+        tf::Executor background_executor{ background_threads() };
+
+        // each scheduled drain pops exactly one slot; frame work is drained ahead of normal work
+        std::array<JobQueue, lane_count> lanes{
+            JobQueue{ slots_per_chunk * max_chunks },
+            JobQueue{ slots_per_chunk * max_chunks },
+            JobQueue{ slots_per_chunk * max_chunks }
         };
+        std::atomic_uint64_t current_frame{ 0 };
+
+        BOZA_PROFILE_ONLY(std::atomic_int64_t jobs_in_flight{ 0 };)
 
-        tf::Executor executor{ std::thread::hardware_concurrency() };
-        std::mutex mutex;
-        std::atomic_size_t next_task_id;
-        std::unordered_map<uint64_t, std::shared_ptr<TaskData>> tasks;
+        std::array<std::atomic<TaskSlot*>, max_chunks> chunks{};
+        std::atomic_uint32_t next_unused_slot{ 0 };
+        // ABA tag in the high half, slot index in the low half
+        std::atomic_uint64_t free_head{ INVALID_SLOT };
 
         friend Singleton;
-        JobSystem() = default;
+        // workers may still record zones while we shut down, so the profiler has to outlive us
+        JobSystem() { BOZA_PROFILE_ONLY((void)Profiler::instance();) }
+        ~JobSystem() override;
     };
 }
+
+#include "JobSystem.inl"
@@ -0,0 +1,102 @@
+#pragma once
+#include "JobSystem.hpp"
+#include "Logger.hpp"
+
+namespace boza
+{
+    template<typename F> requires std::invocable<std::decay_t<F>&>
+    JobSystem::task_id JobSystem::push_task(F&& func, const JobOptions& options)
+    {
+        auto& inst = instance();
+
+        const uint32_t index = inst.acquire_slot();
+        if (index == INVALID_SLOT)
+        {
+            Logger::error("Job system task table is full");
+            return INVALID_TASK_ID;
+        }
+
+        TaskSlot& slot      = inst.get_slot(index);
+        slot.deadline_frame = options.deadline_frame;
+        slot.job.emplace(std::forward<F>(func));
+
+        return inst.submit(index, options.priority);
+    }
+
+
+    template<std::integral I, typename F> requires std::invocable<F&, I>
+    JobError JobSystem::parallel_for(const I begin, const I end, const I grain, F&& func)
+    {
+        if (end <= begin) return JobError::Success;
+
+        return instance().run_chunked(
+            static_cast<size_t>(end - begin), static_cast<size_t>(grain),
+            [begin, &func](const size_t first, const size_t last, size_t)
+            {
+                for (size_t i = first; i < last; ++i)
+                    func(static_cast<I>(begin + static_cast<I>(i)));
+            });
+    }
+
+    template<std::integral I, typename T, typename Map, typename Reduce>
+    std::expected<T, JobError> JobSystem::parallel_reduce(
+        const I begin, const I end, const I grain,
+        T identity, Map&& map, Reduce&& reduce)
+    {
+        if (end <= begin) return identity;
+
+        // empty until the participant maps its first element, so identity is folded in exactly once below
+        struct alignas(64) Partial
+        {
+            std::optional<T> value;
+        };
+
+        auto& inst = instance();
+        std::vector<Partial> partials(inst.max_participants());
+
+        const JobError error = inst.run_chunked(
+            static_cast<size_t>(end - begin), static_cast<size_t>(grain),
+            [begin, &partials, &map, &reduce](const size_t first, const size_t last, const size_t participant)
+            {
+                std::optional<T>& accumulator = partials[participant].value;
+                for (size_t i = first; i < last; ++i)
+                {
+                    auto mapped = map(static_cast<I>(begin + static_cast<I>(i)));
+                    if (accumulator.has_value()) accumulator = reduce(std::move(*accumulator), std::move(mapped));
+                    else accumulator.emplace(std::move(mapped));
+                }
+            });
+
+        if (error != JobError::Success) return std::unexpected(error);
+
+        T result = std::move(identity);
+        for (auto& [value] : partials)
+        {
+            if (value.has_value()) result = reduce(std::move(result), std::move(*value));
+        }
+
+        return result;
+    }
+
+    template<typename View, typename F>
+    JobError JobSystem::parallel_for_each(const View& view, const size_t grain, F&& func)
+    {
+        const auto* leading = view.handle();
+        if (leading == nullptr || leading->empty()) return JobError::Success;
+
+        return instance().run_chunked(
+            leading->size(), grain,
+            [&view, &func, leading](const size_t first, const size_t last, size_t)
+            {
+                const auto* entities = leading->data();
+
+                for (size_t pos = first; pos < last; ++pos)
+                {
+                    const auto entity = entities[pos];
+                    if (!view.contains(entity)) continue;
+
+                    std::apply(func, std::tuple_cat(std::make_tuple(entity), view.get(entity)));
+                }
+            });
+    }
+}
@@ -0,0 +1,44 @@
+#include "TaskGraph.hpp"
+
+namespace boza
+{
+    TaskGraph::Node& TaskGraph::Node::name(const std::string& name)
+    {
+        task.name(name);
+        return *this;
+    }
+
+    bool TaskGraph::Node::empty() const { return task.empty(); }
+
+
+    TaskGraph::TaskGraph(const std::string& name) { taskflow.name(name); }
+
+    TaskGraph::Node TaskGraph::compose(TaskGraph& other)
+    {
+        assert(&other != this && "A task graph cannot be composed of itself");
+        modules.push_back(&other);
+        return Node{ taskflow.composed_of(other.taskflow) };
+    }
+
+    void TaskGraph::clear()
+    {
+        taskflow.clear();
+        modules.clear();
+        failed.store(false);
+    }
+
+    bool   TaskGraph::empty() const { return taskflow.empty(); }
+    size_t TaskGraph::size() const { return taskflow.num_tasks(); }
+
+    bool TaskGraph::has_failed() const
+    {
+        return failed.load() || std::ranges::any_of(modules, &TaskGraph::has_failed);
+    }
+
+    void TaskGraph::reset_failure()
+    {
+        failed.store(false);
+        for (auto* module : modules)
+            module->reset_failure();
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include "boza_pch.hpp"
+
+namespace boza
+{
+    class BOZA_API TaskGraph final
+    {
+    public:
+        class Node
+        {
+        public:
+            Node() = default;
+
+            template<typename... Nodes> Node& precede(Nodes... nodes);
+            template<typename... Nodes> Node& succeed(Nodes... nodes);
+
+            Node& name(const std::string& name);
+            [[nodiscard]] bool empty() const;
+
+        private:
+            friend TaskGraph;
+            explicit Node(const tf::Task& task) : task{ task } {}
+
+            tf::Task task;
+        };
+
+        TaskGraph() = default;
+        explicit TaskGraph(const std::string& name);
+
+        TaskGraph(const TaskGraph&)            = delete;
+        TaskGraph(TaskGraph&&)                 = delete;
+        TaskGraph& operator=(const TaskGraph&) = delete;
+        TaskGraph& operator=(TaskGraph&&)      = delete;
+
+        // F is either void() or void(tf::Subflow&); the latter spawns nested work from inside the job.
+        template<typename F> Node emplace(F&& func);
+        template<typename F> Node then(Node predecessor, F&& func);
+        template<typename F> Node when_all(std::initializer_list<Node> predecessors, F&& func);
+        template<typename... Fs> std::array<Node, sizeof...(Fs)> fan_out(Node predecessor, Fs&&... funcs);
+
+        Node compose(TaskGraph& other);
+
+        void clear();
+        [[nodiscard]] bool   empty() const;
+        [[nodiscard]] size_t size() const;
+        [[nodiscard]] bool   has_failed() const;
+
+    private:
+        friend class JobSystem;
+
+        template<typename F> void guarded(F& func);
+        void reset_failure();
+
+        tf::Taskflow            taskflow;
+        std::vector<TaskGraph*> modules;
+        std::atomic_bool        failed{ false };
+    };
+}
+
+#include "TaskGraph.inl"
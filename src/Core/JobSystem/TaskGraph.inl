@@ -0,0 +1,79 @@
+#pragma once
+#include "TaskGraph.hpp"
+#include "Profiler.hpp"
+
+namespace boza
+{
+    template<typename... Nodes>
+    TaskGraph::Node& TaskGraph::Node::precede(Nodes... nodes)
+    {
+        static_assert((std::is_same_v<Nodes, Node> && ...), "Only nodes of a task graph can be chained");
+        task.precede(nodes.task...);
+        return *this;
+    }
+
+    template<typename... Nodes>
+    TaskGraph::Node& TaskGraph::Node::succeed(Nodes... nodes)
+    {
+        static_assert((std::is_same_v<Nodes, Node> && ...), "Only nodes of a task graph can be chained");
+        task.succeed(nodes.task...);
+        return *this;
+    }
+
+
+    template<typename F>
+    TaskGraph::Node TaskGraph::emplace(F&& func)
+    {
+        using Fn = std::decay_t<F>;
+
+        if constexpr (std::invocable<Fn&, tf::Subflow&>)
+        {
+            return Node{ taskflow.emplace([this, fn = std::forward<F>(func)](tf::Subflow& subflow) mutable
+            {
+                auto call = [&] { fn(subflow); };
+                guarded(call);
+            }) };
+        }
+        else
+        {
+            static_assert(std::invocable<Fn&>, "Task must be callable as void() or void(tf::Subflow&)");
+            return Node{ taskflow.emplace([this, fn = std::forward<F>(func)]() mutable { guarded(fn); }) };
+        }
+    }
+
+    template<typename F>
+    TaskGraph::Node TaskGraph::then(Node predecessor, F&& func)
+    {
+        Node node = emplace(std::forward<F>(func));
+        predecessor.precede(node);
+        return node;
+    }
+
+    template<typename F>
+    TaskGraph::Node TaskGraph::when_all(const std::initializer_list<Node> predecessors, F&& func)
+    {
+        Node node = emplace(std::forward<F>(func));
+        for (Node predecessor : predecessors)
+            predecessor.precede(node);
+        return node;
+    }
+
+    template<typename... Fs>
+    std::array<TaskGraph::Node, sizeof...(Fs)> TaskGraph::fan_out(Node predecessor, Fs&&... funcs)
+    {
+        std::array<Node, sizeof...(Fs)> nodes{ emplace(std::forward<Fs>(funcs))... };
+        for (const Node& node : nodes)
+            predecessor.precede(node);
+        return nodes;
+    }
+
+
+    template<typename F>
+    void TaskGraph::guarded(F& func)
+    {
+        BOZA_PROFILE_ZONE("TaskGraph node");
+
+        try { func(); }
+        catch (...) { failed.store(true); }
+    }
+}
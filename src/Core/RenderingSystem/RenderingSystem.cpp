@@ -1,7 +1,11 @@
 #include "RenderingSystem.hpp"
 
 #include "Logger.hpp"
-#include "Core/GameObject.hpp"
+#include "Profiler.hpp"
+#include "Core/BehaviourDispatcher.hpp"
+#include "Core/EventSystem/EventSystem.hpp"
+#include "Core/JobSystem/JobSystem.hpp"
+#include "Core/TransformHierarchy.hpp"
 
 #include "GPU/Vulkan/Core/Device.hpp"
 #include "Render/Renderer.hpp"
@@ -17,30 +21,21 @@ namespace boza
             return;
         }
 
-        for (const auto* game_object : Scene::get_active_scene().get_game_objects())
-        {
-            for (auto* behaviour : game_object->behaviours)
-                behaviour->start();
-        }
+        BehaviourDispatcher::start();
     }
 
 
     void RenderingSystem::on_iteration()
     {
-        hash_set<GameObject*> game_objects = Scene::get_active_scene().get_game_objects();
-        const duration dt = get_delta_time();
+        BOZA_PROFILE_FRAME();
+        JobSystem::begin_frame();
+        EventSystem::dispatch_queued();
 
-        for (const auto* game_object : game_objects)
-        {
-            for (auto* behaviour : game_object->behaviours)
-                behaviour->update(dt);
-        }
+        const duration dt = get_delta_time();
 
-        for (const auto* game_object : game_objects)
-        {
-            for (auto* behaviour : game_object->behaviours)
-                behaviour->late_update(dt);
-        }
+        BehaviourDispatcher::update(dt);
+        BehaviourDispatcher::late_update(dt);
+        TransformHierarchy::update();
 
         if (!Renderer::render())
         {
@@ -1,7 +1,6 @@
 #include "Scene.hpp"
 
 #include "GameObject.hpp"
-#include "Components/GameObjData.hpp"
 
 namespace boza
 {
@@ -37,18 +36,7 @@ namespace boza
     }
 
 
-    hash_set<GameObject*> Scene::get_game_objects() const
-    {
-        hash_set<GameObject*> game_objects;
-
-        for (const auto& entity : this->game_objects)
-        {
-            auto data = registry().get<GameObjData>(entity);
-            game_objects.emplace(&data.get_game_object());
-        }
-
-        return game_objects;
-    }
+    std::span<GameObject* const> Scene::get_game_objects() const { return game_objects; }
 
 
     Scene& Scene::get_active_scene()
@@ -66,17 +54,29 @@ namespace boza
     const std::string& Scene::get_name() const { return name; }
 
 
-    void Scene::push_game_object(const GameObject* game_object)
+    void Scene::push_game_object(GameObject* game_object)
     {
         assert(game_object != nullptr && "Game object is nullptr.");
-        assert(!active_scene()->game_objects.contains(game_object->get_id()) && "Game object already exists in scene.");
-        active_scene()->game_objects.emplace(game_object->get_id());
+        Scene* scene = active_scene();
+        assert(!scene->game_object_indices.contains(game_object->get_id()) && "Game object already exists in scene.");
+
+        scene->game_object_indices.emplace(game_object->get_id(), scene->game_objects.size());
+        scene->game_objects.push_back(game_object);
     }
 
     void Scene::pop_game_object(const GameObject* game_object)
     {
         assert(game_object != nullptr && "Game object is nullptr.");
-        assert(active_scene()->game_objects.contains(game_object->get_id()) && "Game object does not exist in scene.");
-        active_scene()->game_objects.erase(game_object->get_id());
+        Scene* scene = active_scene();
+        assert(scene->game_object_indices.contains(game_object->get_id()) && "Game object does not exist in scene.");
+
+        const size_t index = scene->game_object_indices.at(game_object->get_id());
+        GameObject*  last  = scene->game_objects.back();
+
+        scene->game_objects[index]                 = last;
+        scene->game_object_indices[last->get_id()] = index;
+
+        scene->game_objects.pop_back();
+        scene->game_object_indices.erase(game_object->get_id());
     }
 }
@@ -4,27 +4,35 @@
 namespace boza
 {
     class GameObject;
+    class BehaviourDispatcher;
 
     class BOZA_API Scene final
     {
         friend GameObject;
+        friend BehaviourDispatcher;
 
     public:
         explicit Scene(const std::string& name);
         ~Scene();
 
         [[nodiscard]] const std::string& get_name() const;
-        [[nodiscard]] hash_set<GameObject*> get_game_objects() const;
+        // Live objects in a contiguous array, in no particular order. Creating or destroying an object invalidates
+        // the span, and destroying one moves the last object into its place.
+        [[nodiscard]] std::span<GameObject* const> get_game_objects() const;
 
         [[nodiscard]] static Scene& get_active_scene();
         [[nodiscard]] static Scene& get(const std::string& name);
 
+        template<typename... Components>
+        [[nodiscard]] static auto view() { return registry().view<Components...>(); }
+
     private:
-        static void push_game_object(const GameObject* game_object);
+        static void push_game_object(GameObject* game_object);
         static void pop_game_object(const GameObject* game_object);
 
         std::string name;
-        hash_set<entt::entity> game_objects;
+        std::vector<GameObject*>       game_objects;
+        hash_map<entt::entity, size_t> game_object_indices;
 
         static entt::registry& registry();
         static Scene*& active_scene();
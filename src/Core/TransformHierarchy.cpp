@@ -0,0 +1,382 @@
+#include "TransformHierarchy.hpp"
+#include "Logger.hpp"
+#include "JobSystem/JobSystem.hpp"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64)
+#include <xmmintrin.h>
+#endif
+
+namespace boza
+{
+    namespace
+    {
+        glm::mat4 compose(const glm::vec3& position, const glm::vec3& rotation, const glm::vec3& scale)
+        {
+            const glm::mat3 basis = glm::mat3_cast(glm::quat{ rotation });
+
+            return glm::mat4{
+                glm::vec4{ basis[0] * scale.x, 0.0f },
+                glm::vec4{ basis[1] * scale.y, 0.0f },
+                glm::vec4{ basis[2] * scale.z, 0.0f },
+                glm::vec4{ position, 1.0f }
+            };
+        }
+
+        // out = a * b, column-major; a and out may not alias
+        void multiply(const glm::mat4& a, const glm::mat4& b, glm::mat4& out)
+        {
+#if defined(__AVX__)
+            const __m256 a0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&a[0]));
+            const __m256 a1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&a[1]));
+            const __m256 a2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&a[2]));
+            const __m256 a3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&a[3]));
+
+            // two result columns per iteration
+            for (int column = 0; column < 4; column += 2)
+            {
+                const float* lo = &b[column][0];
+                const float* hi = &b[column + 1][0];
+
+                __m256 result = _mm256_mul_ps(a0, _mm256_setr_ps(lo[0], lo[0], lo[0], lo[0], hi[0], hi[0], hi[0], hi[0]));
+                result = _mm256_add_ps(result, _mm256_mul_ps(a1, _mm256_setr_ps(lo[1], lo[1], lo[1], lo[1], hi[1], hi[1], hi[1], hi[1])));
+                result = _mm256_add_ps(result, _mm256_mul_ps(a2, _mm256_setr_ps(lo[2], lo[2], lo[2], lo[2], hi[2], hi[2], hi[2], hi[2])));
+                result = _mm256_add_ps(result, _mm256_mul_ps(a3, _mm256_setr_ps(lo[3], lo[3], lo[3], lo[3], hi[3], hi[3], hi[3], hi[3])));
+
+                _mm256_storeu_ps(&out[column][0], result);
+            }
+#elif defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64)
+            const __m128 a0 = _mm_loadu_ps(&a[0][0]);
+            const __m128 a1 = _mm_loadu_ps(&a[1][0]);
+            const __m128 a2 = _mm_loadu_ps(&a[2][0]);
+            const __m128 a3 = _mm_loadu_ps(&a[3][0]);
+
+            for (int column = 0; column < 4; ++column)
+            {
+                const float* c = &b[column][0];
+
+                __m128 result = _mm_mul_ps(a0, _mm_set1_ps(c[0]));
+                result = _mm_add_ps(result, _mm_mul_ps(a1, _mm_set1_ps(c[1])));
+                result = _mm_add_ps(result, _mm_mul_ps(a2, _mm_set1_ps(c[2])));
+                result = _mm_add_ps(result, _mm_mul_ps(a3, _mm_set1_ps(c[3])));
+
+                _mm_storeu_ps(&out[column][0], result);
+            }
+#else
+            out = a * b;
+#endif
+        }
+    }
+
+
+    transform_node_t TransformHierarchy::create(const glm::vec3& position, const glm::vec3& rotation, const glm::vec3& scale)
+    {
+        auto& inst = instance();
+        std::scoped_lock lock{ inst.mutex };
+
+        transform_node_t node;
+        if (!inst.free_nodes.empty())
+        {
+            node = inst.free_nodes.back();
+            inst.free_nodes.pop_back();
+        }
+        else
+        {
+            node = static_cast<transform_node_t>(inst.node_to_index.size());
+            inst.node_to_index.push_back(INVALID_INDEX);
+        }
+
+        inst.node_to_index[node] = static_cast<uint32_t>(inst.nodes.size());
+
+        inst.nodes.push_back(node);
+        inst.parent_nodes.push_back(INVALID_TRANSFORM_NODE);
+        inst.parents.push_back(INVALID_INDEX);
+        inst.positions.push_back(position);
+        inst.rotations.push_back(rotation);
+        inst.scales.push_back(scale);
+        inst.local_dirty.push_back(1);
+        inst.world_dirty.push_back(1);
+        inst.changed.push_back(0);
+        inst.local_matrices.emplace_back(1.0f);
+        inst.world_matrices.emplace_back(1.0f);
+
+        inst.order_dirty = true;
+        return node;
+    }
+
+    void TransformHierarchy::destroy(const transform_node_t node)
+    {
+        auto& inst = instance();
+        std::scoped_lock lock{ inst.mutex };
+
+        const uint32_t index = inst.index_of(node);
+        const uint32_t last  = static_cast<uint32_t>(inst.nodes.size()) - 1;
+
+        // orphans become roots and keep their local transform
+        for (uint32_t i = 0; i <= last; ++i)
+        {
+            if (inst.parent_nodes[i] != node) continue;
+
+            inst.parent_nodes[i] = INVALID_TRANSFORM_NODE;
+            inst.world_dirty[i]  = 1;
+        }
+
+        const auto swap_remove = [index, last](auto& values)
+        {
+            values[index] = std::move(values[last]);
+            values.pop_back();
+        };
+
+        inst.node_to_index[inst.nodes[last]] = index;
+        inst.node_to_index[node]             = INVALID_INDEX;
+
+        swap_remove(inst.nodes);
+        swap_remove(inst.parent_nodes);
+        swap_remove(inst.parents);
+        swap_remove(inst.positions);
+        swap_remove(inst.rotations);
+        swap_remove(inst.scales);
+        swap_remove(inst.local_dirty);
+        swap_remove(inst.world_dirty);
+        swap_remove(inst.changed);
+        swap_remove(inst.local_matrices);
+        swap_remove(inst.world_matrices);
+
+        inst.free_nodes.push_back(node);
+        inst.order_dirty = true;
+    }
+
+
+    bool TransformHierarchy::set_parent(const transform_node_t node, const transform_node_t parent)
+    {
+        auto& inst = instance();
+        std::scoped_lock lock{ inst.mutex };
+
+        const uint32_t index = inst.index_of(node);
+
+        for (transform_node_t ancestor = parent; ancestor != INVALID_TRANSFORM_NODE;
+             ancestor = inst.parent_nodes[inst.index_of(ancestor)])
+        {
+            if (ancestor == node)
+            {
+                Logger::error("Cannot parent a transform to itself or one of its descendants");
+                return false;
+            }
+        }
+
+        inst.parent_nodes[index] = parent;
+        inst.world_dirty[index]  = 1;
+        inst.order_dirty         = true;
+        return true;
+    }
+
+    transform_node_t TransformHierarchy::get_parent(const transform_node_t node)
+    {
+        auto&            inst = instance();
+        std::shared_lock lock{ inst.mutex };
+        return inst.parent_nodes[inst.index_of(node)];
+    }
+
+
+    void TransformHierarchy::set_position(const transform_node_t node, const glm::vec3& position)
+    {
+        auto&            inst  = instance();
+        std::shared_lock lock{ inst.mutex };
+        const uint32_t   index = inst.index_of(node);
+
+        inst.positions[index]   = position;
+        inst.local_dirty[index] = 1;
+    }
+
+    void TransformHierarchy::set_rotation(const transform_node_t node, const glm::vec3& rotation)
+    {
+        auto&            inst  = instance();
+        std::shared_lock lock{ inst.mutex };
+        const uint32_t   index = inst.index_of(node);
+
+        inst.rotations[index]   = rotation;
+        inst.local_dirty[index] = 1;
+    }
+
+    void TransformHierarchy::set_scale(const transform_node_t node, const glm::vec3& scale)
+    {
+        auto&            inst  = instance();
+        std::shared_lock lock{ inst.mutex };
+        const uint32_t   index = inst.index_of(node);
+
+        inst.scales[index]      = scale;
+        inst.local_dirty[index] = 1;
+    }
+
+    glm::vec3 TransformHierarchy::get_position(const transform_node_t node)
+    {
+        auto&            inst = instance();
+        std::shared_lock lock{ inst.mutex };
+        return inst.positions[inst.index_of(node)];
+    }
+
+    glm::vec3 TransformHierarchy::get_rotation(const transform_node_t node)
+    {
+        auto&            inst = instance();
+        std::shared_lock lock{ inst.mutex };
+        return inst.rotations[inst.index_of(node)];
+    }
+
+    glm::vec3 TransformHierarchy::get_scale(const transform_node_t node)
+    {
+        auto&            inst = instance();
+        std::shared_lock lock{ inst.mutex };
+        return inst.scales[inst.index_of(node)];
+    }
+
+    glm::mat4 TransformHierarchy::get_world_matrix(const transform_node_t node)
+    {
+        auto&            inst = instance();
+        std::shared_lock lock{ inst.mutex };
+        return inst.world_matrices[inst.index_of(node)];
+    }
+
+    uint32_t TransformHierarchy::get_index(const transform_node_t node)
+    {
+        auto&            inst = instance();
+        std::shared_lock lock{ inst.mutex };
+        return inst.index_of(node);
+    }
+
+
+    void TransformHierarchy::update()
+    {
+        auto& inst = instance();
+        std::scoped_lock lock{ inst.mutex };
+
+        if (inst.order_dirty) inst.rebuild_order();
+
+        for (size_t level = 0; level + 1 < inst.level_offsets.size(); ++level)
+        {
+            const size_t begin = inst.level_offsets[level];
+            const size_t end   = inst.level_offsets[level + 1];
+
+            if (end - begin < parallel_threshold)
+            {
+                inst.update_range(begin, end);
+                continue;
+            }
+
+            // the lock is held across the fan-out; this only works because run_chunked never waits on a helper
+            // that has not started, so a worker parked in a setter cannot hold the level up
+            const size_t   batches = (end - begin + parallel_grain - 1) / parallel_grain;
+            const JobError error   = JobSystem::parallel_for<size_t>(0, batches, 1, [&inst, begin, end](const size_t batch)
+            {
+                const size_t first = begin + batch * parallel_grain;
+                inst.update_range(first, std::min(first + parallel_grain, end));
+            });
+
+            if (error != JobError::Success)
+            {
+                // some batches of this level may not have run; redo it and everything below on the next update
+                Logger::error("Failed to update transform level {}", level);
+                std::fill(inst.world_dirty.begin() + static_cast<ptrdiff_t>(begin), inst.world_dirty.end(), uint8_t{ 1 });
+                return;
+            }
+        }
+    }
+
+    void TransformHierarchy::update_range(const size_t begin, const size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            const uint32_t parent = parents[i];
+            const bool     dirty  = local_dirty[i] || world_dirty[i] || (parent != INVALID_INDEX && changed[parent]);
+
+            // flags are consumed per node, the parent's are read through changed
+            if (local_dirty[i]) local_matrices[i] = compose(positions[i], rotations[i], scales[i]);
+            local_dirty[i] = 0;
+            world_dirty[i] = 0;
+            changed[i]     = dirty;
+
+            if (!dirty) continue;
+
+            if (parent == INVALID_INDEX) world_matrices[i] = local_matrices[i];
+            else multiply(world_matrices[parent], local_matrices[i], world_matrices[i]);
+        }
+    }
+
+
+    void TransformHierarchy::rebuild_order()
+    {
+        const size_t count = nodes.size();
+
+        std::vector<uint32_t> depths(count, INVALID_INDEX);
+        std::vector<uint32_t> chain;
+        uint32_t              max_depth = 0;
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            uint32_t current = i;
+            while (depths[current] == INVALID_INDEX && parent_nodes[current] != INVALID_TRANSFORM_NODE)
+            {
+                chain.push_back(current);
+                current = index_of(parent_nodes[current]);
+            }
+
+            uint32_t depth = depths[current] == INVALID_INDEX ? 0 : depths[current];
+            depths[current] = depth;
+
+            while (!chain.empty())
+            {
+                depths[chain.back()] = ++depth;
+                chain.pop_back();
+            }
+
+            max_depth = std::max(max_depth, depths[i]);
+        }
+
+        level_offsets.assign(count != 0 ? max_depth + 2 : 1, 0);
+        for (const uint32_t depth : depths)
+            ++level_offsets[depth + 1];
+        for (size_t level = 1; level < level_offsets.size(); ++level)
+            level_offsets[level] += level_offsets[level - 1];
+
+        // stable counting sort by depth: order[new] = old
+        std::vector<uint32_t> order(count);
+        std::vector<size_t>   cursor(level_offsets.begin(), level_offsets.end() - 1);
+        for (uint32_t i = 0; i < count; ++i)
+            order[cursor[depths[i]]++] = i;
+
+        const auto permute = [&order, count](auto& values)
+        {
+            std::remove_reference_t<decltype(values)> sorted;
+            sorted.reserve(count);
+            for (const uint32_t old : order)
+                sorted.push_back(std::move(values[old]));
+            values = std::move(sorted);
+        };
+
+        permute(nodes);
+        permute(parent_nodes);
+        permute(positions);
+        permute(rotations);
+        permute(scales);
+        permute(local_dirty);
+        permute(world_dirty);
+        permute(changed);
+        permute(local_matrices);
+        permute(world_matrices);
+
+        for (uint32_t i = 0; i < count; ++i)
+            node_to_index[nodes[i]] = i;
+
+        parents.resize(count);
+        for (uint32_t i = 0; i < count; ++i)
+            parents[i] = parent_nodes[i] != INVALID_TRANSFORM_NODE ? node_to_index[parent_nodes[i]] : INVALID_INDEX;
+
+        order_dirty = false;
+    }
+
+    uint32_t TransformHierarchy::index_of(const transform_node_t node) const
+    {
+        assert(node < node_to_index.size() && node_to_index[node] != INVALID_INDEX && "Transform node does not exist");
+        return node_to_index[node];
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include "boza_pch.hpp"
+#include "Singleton.hpp"
+
+namespace boza
+{
+    using transform_node_t = uint32_t;
+    static constexpr transform_node_t INVALID_TRANSFORM_NODE = std::numeric_limits<transform_node_t>::max();
+
+    // Owns every transform in depth-sorted SoA arrays so parents are always resolved before their children.
+    // Structural changes (create, destroy, set_parent) and update() are serialised against everything else. Setters and
+    // getters may run on any thread and wait while update() runs; a setter may only overlap other accesses to distinct
+    // nodes.
+    class BOZA_API TransformHierarchy final : public Singleton<TransformHierarchy>
+    {
+    public:
+        static transform_node_t create(const glm::vec3& position, const glm::vec3& rotation, const glm::vec3& scale);
+        static void             destroy(transform_node_t node);
+
+        // INVALID_TRANSFORM_NODE detaches; fails if the parent is the node itself or one of its descendants.
+        static bool                           set_parent(transform_node_t node, transform_node_t parent);
+        [[nodiscard]] static transform_node_t get_parent(transform_node_t node);
+
+        static void set_position(transform_node_t node, const glm::vec3& position);
+        static void set_rotation(transform_node_t node, const glm::vec3& rotation);
+        static void set_scale(transform_node_t node, const glm::vec3& scale);
+
+        // Getters return copies taken under the lock, so they wait for update() and stay valid afterwards.
+        [[nodiscard]] static glm::vec3 get_position(transform_node_t node);
+        [[nodiscard]] static glm::vec3 get_rotation(transform_node_t node);
+        [[nodiscard]] static glm::vec3 get_scale(transform_node_t node);
+
+        // As of the last update().
+        [[nodiscard]] static glm::mat4 get_world_matrix(transform_node_t node);
+        // Dense index, only stable until the next structural change or update().
+        [[nodiscard]] static uint32_t  get_index(transform_node_t node);
+
+        // Recomputes world matrices of every subtree touched since the previous call. Not from a job worker: a
+        // setter picked up while waiting on the fan-out would block on the lock we already hold.
+        static void update();
+
+    private:
+        static constexpr uint32_t INVALID_INDEX      = std::numeric_limits<uint32_t>::max();
+        static constexpr size_t   parallel_threshold = 4096;
+        static constexpr size_t   parallel_grain     = 1024;
+
+        [[nodiscard]] uint32_t index_of(transform_node_t node) const;
+
+        void rebuild_order();
+        void update_range(size_t begin, size_t end);
+
+        // dense, sorted by depth; parents holds dense indices and is only valid after rebuild_order()
+        std::vector<transform_node_t> nodes;
+        std::vector<transform_node_t> parent_nodes;
+        std::vector<uint32_t>         parents;
+        std::vector<glm::vec3>        positions;
+        std::vector<glm::vec3>        rotations;
+        std::vector<glm::vec3>        scales;
+        std::vector<uint8_t>          local_dirty;
+        std::vector<uint8_t>          world_dirty;
+        // world matrix recomputed by the running update(), read by the next level
+        std::vector<uint8_t>          changed;
+        std::vector<glm::mat4>        local_matrices;
+        std::vector<glm::mat4>        world_matrices;
+
+        // depth d occupies [level_offsets[d], level_offsets[d + 1])
+        std::vector<size_t> level_offsets;
+        bool                order_dirty{ false };
+
+        std::vector<uint32_t>         node_to_index;
+        std::vector<transform_node_t> free_nodes;
+
+        // shared by setters, exclusive for update() and structural changes
+        std::shared_mutex mutex;
+
+        friend Singleton;
+        TransformHierarchy() = default;
+    };
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include "boza_pch.hpp"
 #include "Logger.hpp"
+#include "Profiler.hpp"
 #include "SystemBase.hpp"
 
 namespace boza
@@ -42,12 +43,16 @@ namespace boza
                 {
                     int dropped_steps = (accumulated_time - max_catch_up_time) / fixed_delta_time.load();
                     Logger::trace("System is running behind. Dropping {} steps.", dropped_steps);
+                    BOZA_PROFILE_COUNTER("Dropped steps", dropped_steps);
                     accumulated_time = max_catch_up_time;
                 }
 
                 while (accumulated_time >= fixed_delta_time.load())
                 {
-                    this->on_iteration();
+                    {
+                        BOZA_PROFILE_ZONE(entt::type_name<Derived>::value());
+                        this->on_iteration();
+                    }
                     accumulated_time -= fixed_delta_time.load();
                 }
 
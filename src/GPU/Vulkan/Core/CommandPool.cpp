@@ -120,16 +120,36 @@ namespace boza
             .pSignalSemaphores = nullptr
         };
 
-        if (vkQueueSubmit(Device::get_graphics_queue(), 1, &submit_info, nullptr) != VK_SUCCESS)
+        constexpr VkFenceCreateInfo fence_info
+        {
+            .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0
+        };
+
+        VkFence fence;
+        if (vkCreateFence(Device::get_device(), &fence_info, nullptr, &fence) != VK_SUCCESS)
+        {
+            Logger::error("Failed to create fence for single time commands");
+            vkFreeCommandBuffers(Device::get_device(), instance().command_pool, 1, &command_buffer);
+            return false;
+        }
+
+        if (vkQueueSubmit(Device::get_graphics_queue(), 1, &submit_info, fence) != VK_SUCCESS)
         {
             Logger::error("Failed to submit command buffer for single time commands");
+            vkDestroyFence(Device::get_device(), fence, nullptr);
             vkFreeCommandBuffers(Device::get_device(), instance().command_pool, 1, &command_buffer);
             return false;
         }
 
-        if (vkQueueWaitIdle(Device::get_graphics_queue()) != VK_SUCCESS)
+        // waits for this submission only, not for the frames already queued behind it
+        const bool completed = vkWaitForFences(Device::get_device(), 1, &fence, VK_TRUE, UINT64_MAX) == VK_SUCCESS;
+        vkDestroyFence(Device::get_device(), fence, nullptr);
+
+        if (!completed)
         {
-            Logger::error("Failed to wait for graphics queue to become idle");
+            Logger::error("Failed to wait for single time commands");
             return false;
         }
 
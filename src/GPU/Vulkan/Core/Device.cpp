@@ -115,10 +115,22 @@ namespace boza
 
             if (!suitable) continue;
 
+            VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT supported_gpl_features
+            {
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT,
+                .pNext = nullptr
+            };
+
+            VkPhysicalDeviceVulkan12Features supported_vk12_features
+            {
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+                .pNext = &supported_gpl_features
+            };
+
             VkPhysicalDeviceVulkan13Features supported_vk13_features
             {
                 .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES,
-                .pNext = nullptr
+                .pNext = &supported_vk12_features
             };
 
             VkPhysicalDeviceFeatures2 device_features2
@@ -130,9 +142,25 @@ namespace boza
             vkGetPhysicalDeviceFeatures2(device, &device_features2);
 
             if (!supported_vk13_features.synchronization2 ||
-                !supported_vk13_features.dynamicRendering)
+                !supported_vk13_features.dynamicRendering ||
+                !supported_vk12_features.timelineSemaphore)
                 continue;
 
+            indirect_count_supported =
+                device_features2.features.multiDrawIndirect &&
+                device_features2.features.drawIndirectFirstInstance &&
+                supported_vk12_features.drawIndirectCount;
+
+            // optional; pipelines are compiled monolithically without it
+            graphics_pipeline_library_supported =
+                std::ranges::all_of(graphics_pipeline_library_extensions, [&](const char* extension)
+                {
+                    return supported_extensions_set.contains(extension);
+                }) &&
+                supported_gpl_features.graphicsPipelineLibrary;
+
+            Logger::trace("{} graphics pipeline libraries", graphics_pipeline_library_supported ? "Using" : "Not using");
+
             physical_device = device;
             Logger::trace("{} is a suitable device", device_properties.deviceName);
             return true;
@@ -177,11 +205,41 @@ namespace boza
                 Logger::trace("Queue family {} supports presentation", i);
             }
 
-            if (found_graphics_family && found_present_family) return true;
+            if (found_graphics_family && found_present_family) break;
         }
 
-        Logger::critical("Could not find a suitable device with graphics and presentation support");
-        return false;
+        if (!found_graphics_family || !found_present_family)
+        {
+            Logger::critical("Could not find a suitable device with graphics and presentation support");
+            return false;
+        }
+
+        // prefer a pure DMA family, then an async compute family, then share the graphics queue
+        queue_family_indices.transfer_family = queue_family_indices.graphics_family;
+        bool found_transfer_family = false;
+
+        for (uint32_t i = 0; i < queue_family_count; ++i)
+        {
+            const VkQueueFlags flags = queue_families[i].queueFlags;
+            if (!(flags & VK_QUEUE_TRANSFER_BIT) || flags & VK_QUEUE_GRAPHICS_BIT) continue;
+
+            const bool dedicated = !(flags & VK_QUEUE_COMPUTE_BIT);
+            if (found_transfer_family && !dedicated) continue;
+
+            queue_family_indices.transfer_family = i;
+            found_transfer_family = true;
+
+            if (dedicated) break;
+        }
+
+        transfer_granularity = queue_families[queue_family_indices.transfer_family].minImageTransferGranularity;
+
+        if (queue_family_indices.transfer_family != queue_family_indices.graphics_family)
+            Logger::trace("Queue family {} is used for transfers", queue_family_indices.transfer_family);
+        else
+            Logger::trace("No dedicated transfer queue family, transfers go through the graphics queue");
+
+        return true;
     }
 
     bool Device::create_logical_device()
@@ -191,7 +249,8 @@ namespace boza
         const std::set unique_queue_families
         {
             queue_family_indices.graphics_family,
-            queue_family_indices.present_family
+            queue_family_indices.present_family,
+            queue_family_indices.transfer_family
         };
 
         std::vector<VkDeviceQueueCreateInfo> queue_create_infos;
@@ -209,14 +268,38 @@ namespace boza
             });
         }
 
+        VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT gpl_features
+        {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT,
+            .pNext = nullptr,
+            .graphicsPipelineLibrary = VK_TRUE
+        };
+
+        VkPhysicalDeviceVulkan12Features vk12_features
+        {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+            .pNext = graphics_pipeline_library_supported ? &gpl_features : nullptr,
+            .drawIndirectCount = indirect_count_supported,
+            .timelineSemaphore = VK_TRUE,
+        };
+
         VkPhysicalDeviceVulkan13Features vk13_features
         {
             .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES,
+            .pNext = &vk12_features,
             .synchronization2 = VK_TRUE,
             .dynamicRendering = VK_TRUE,
         };
 
-        VkPhysicalDeviceFeatures device_features{};
+        VkPhysicalDeviceFeatures device_features
+        {
+            .multiDrawIndirect = indirect_count_supported,
+            .drawIndirectFirstInstance = indirect_count_supported
+        };
+
+        std::vector<const char*> extensions{ std::begin(required_extensions), std::end(required_extensions) };
+        if (graphics_pipeline_library_supported)
+            extensions.insert(extensions.end(), std::begin(graphics_pipeline_library_extensions), std::end(graphics_pipeline_library_extensions));
 
         const VkDeviceCreateInfo device_create_info
         {
@@ -227,8 +310,8 @@ namespace boza
             .pQueueCreateInfos = queue_create_infos.data(),
             .enabledLayerCount = 0,
             .ppEnabledLayerNames = nullptr,
-            .enabledExtensionCount = static_cast<uint32_t>(std::size(required_extensions)),
-            .ppEnabledExtensionNames = required_extensions,
+            .enabledExtensionCount = static_cast<uint32_t>(extensions.size()),
+            .ppEnabledExtensionNames = extensions.data(),
             .pEnabledFeatures = &device_features,
         };
 
@@ -247,6 +330,7 @@ namespace boza
     {
         vkGetDeviceQueue(device, queue_family_indices.graphics_family, 0, &graphics_queue);
         vkGetDeviceQueue(device, queue_family_indices.present_family, 0, &present_queue);
+        vkGetDeviceQueue(device, queue_family_indices.transfer_family, 0, &transfer_queue);
     }
 
     void Device::wait_idle()
@@ -266,4 +350,8 @@ namespace boza
     Device::QueueFamilyIndices& Device::get_queue_family_indices() { return instance().queue_family_indices; }
     VkQueue&                    Device::get_graphics_queue() { return instance().graphics_queue; }
     VkQueue&                    Device::get_present_queue() { return instance().present_queue; }
+    VkQueue&                    Device::get_transfer_queue() { return instance().transfer_queue; }
+    const VkExtent3D&           Device::get_transfer_granularity() { return instance().transfer_granularity; }
+    bool                        Device::supports_indirect_count() { return instance().indirect_count_supported; }
+    bool                        Device::supports_graphics_pipeline_library() { return instance().graphics_pipeline_library_supported; }
 }
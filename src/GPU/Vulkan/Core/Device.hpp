@@ -11,6 +11,8 @@ namespace boza
         {
             uint32_t graphics_family;
             uint32_t present_family;
+            // a transfer-only family when the device has one, otherwise the graphics family
+            uint32_t transfer_family;
         };
 
         [[nodiscard]]
@@ -25,6 +27,14 @@ namespace boza
         [[nodiscard]] static QueueFamilyIndices& get_queue_family_indices();
         [[nodiscard]] static VkQueue&            get_graphics_queue();
         [[nodiscard]] static VkQueue&            get_present_queue();
+        [[nodiscard]] static VkQueue&            get_transfer_queue();
+        // minImageTransferGranularity of the transfer family; (0, 0, 0) only allows whole mip levels
+        [[nodiscard]] static const VkExtent3D&   get_transfer_granularity();
+
+        // multiDrawIndirect, drawIndirectFirstInstance and drawIndirectCount, enabled together when all are present
+        [[nodiscard]] static bool supports_indirect_count();
+        // VK_EXT_graphics_pipeline_library, so graphics pipelines can be linked from separately compiled parts
+        [[nodiscard]] static bool supports_graphics_pipeline_library();
 
         static void wait_idle();
 
@@ -43,8 +53,18 @@ namespace boza
         QueueFamilyIndices queue_family_indices{};
         VkQueue            graphics_queue{ nullptr };
         VkQueue            present_queue{ nullptr };
+        VkQueue            transfer_queue{ nullptr };
+        VkExtent3D         transfer_granularity{ 1, 1, 1 };
+
+        bool indirect_count_supported{ false };
+        bool graphics_pipeline_library_supported{ false };
 
         constexpr static const char* required_extensions[]{ VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+        constexpr static const char* graphics_pipeline_library_extensions[]
+        {
+            VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME,
+            VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME
+        };
 
         friend Singleton;
         Device() = default;
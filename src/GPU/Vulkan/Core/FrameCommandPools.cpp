@@ -0,0 +1,102 @@
+#include "FrameCommandPools.hpp"
+
+#include "Device.hpp"
+#include "Logger.hpp"
+
+namespace boza
+{
+    bool FrameCommandPools::create(const uint32_t slot_count)
+    {
+        auto& inst = instance();
+        inst.slot_count = slot_count;
+
+        const VkCommandPoolCreateInfo pool_info
+        {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+            .queueFamilyIndex = Device::get_queue_family_indices().graphics_family
+        };
+
+        for (auto& slots : inst.frames)
+        {
+            slots.resize(slot_count);
+            for (auto& slot : slots)
+            {
+                VK_CHECK(vkCreateCommandPool(Device::get_device(), &pool_info, nullptr, &slot.command_pool),
+                {
+                    LOG_VK_ERROR("Failed to create frame command pool");
+                    return false;
+                });
+            }
+        }
+
+        return true;
+    }
+
+    void FrameCommandPools::destroy()
+    {
+        auto& inst = instance();
+
+        for (auto& slots : inst.frames)
+        {
+            // destroying a pool frees its command buffers
+            for (const auto& slot : slots)
+                vkDestroyCommandPool(Device::get_device(), slot.command_pool, nullptr);
+            slots.clear();
+        }
+
+        inst.slot_count = 0;
+    }
+
+
+    bool FrameCommandPools::begin_frame()
+    {
+        for (auto& slot : instance().frames[Swapchain::current_frame_idx()])
+        {
+            if (slot.used == 0) continue;
+
+            VK_CHECK(vkResetCommandPool(Device::get_device(), slot.command_pool, 0),
+            {
+                LOG_VK_ERROR("Failed to reset frame command pool");
+                return false;
+            });
+
+            slot.used = 0;
+        }
+
+        return true;
+    }
+
+    VkCommandBuffer FrameCommandPools::get_secondary(const uint32_t slot)
+    {
+        auto& inst = instance();
+        assert(slot < inst.slot_count && "Command pool slot out of range");
+
+        Slot& pool = inst.frames[Swapchain::current_frame_idx()][slot];
+        if (pool.used == pool.command_buffers.size())
+        {
+            const VkCommandBufferAllocateInfo alloc_info
+            {
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+                .pNext = nullptr,
+                .commandPool = pool.command_pool,
+                .level = VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+                .commandBufferCount = 1
+            };
+
+            VkCommandBuffer command_buffer;
+            VK_CHECK(vkAllocateCommandBuffers(Device::get_device(), &alloc_info, &command_buffer),
+            {
+                LOG_VK_ERROR("Failed to allocate secondary command buffer");
+                return nullptr;
+            });
+
+            pool.command_buffers.push_back(command_buffer);
+        }
+
+        return pool.command_buffers[pool.used++];
+    }
+
+    uint32_t FrameCommandPools::get_slot_count() { return instance().slot_count; }
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include "boza_pch.hpp"
+#include "Singleton.hpp"
+#include "Swapchain.hpp"
+
+namespace boza
+{
+    // Transient graphics command pools for parallel recording, one per slot and frame in flight. A slot is meant
+    // to be owned by a single worker at a time; its buffers are handed out in order and the whole frame's pools
+    // are reset at once instead of resetting buffers individually.
+    class FrameCommandPools final : public Singleton<FrameCommandPools>
+    {
+    public:
+        [[nodiscard]] static bool create(uint32_t slot_count = std::max(1u, std::thread::hardware_concurrency()));
+        static void destroy();
+
+        // Resets the current frame's pools; call after Swapchain::acquire_next_image has waited on its fence.
+        [[nodiscard]] static bool begin_frame();
+
+        // Not yet begun; only valid until the same frame index comes around again.
+        [[nodiscard]] static VkCommandBuffer get_secondary(uint32_t slot);
+
+        [[nodiscard]] static uint32_t get_slot_count();
+
+    private:
+        struct Slot
+        {
+            VkCommandPool                command_pool{ nullptr };
+            std::vector<VkCommandBuffer> command_buffers;
+            uint32_t                     used{ 0 };
+        };
+
+        std::array<std::vector<Slot>, Swapchain::max_frames_in_flight> frames{};
+        uint32_t                                                       slot_count{ 0 };
+
+        friend Singleton;
+        FrameCommandPools() = default;
+    };
+}
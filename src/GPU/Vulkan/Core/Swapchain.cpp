@@ -4,6 +4,7 @@
 #include "Device.hpp"
 #include "Logger.hpp"
 #include "Core/Window.hpp"
+#include "GPU/Vulkan/Memory/StagingRing.hpp"
 
 namespace boza
 {
@@ -106,12 +107,9 @@ namespace boza
     }
 
 
-    bool Swapchain::begin_render_pass(uint32_t image_idx)
+    bool Swapchain::begin_command_buffer()
     {
-        auto&       inst       = instance();
-        const auto& frame      = inst.frames[Frame::current_frame];
-        const auto& image      = inst.images[image_idx];
-        const auto& image_view = inst.image_views[image_idx];
+        const auto& frame = instance().frames[Frame::current_frame];
 
         VK_CHECK(vkResetCommandBuffer(frame.command_buffer, {}),
         {
@@ -133,6 +131,16 @@ namespace boza
             return false;
         });
 
+        return true;
+    }
+
+    bool Swapchain::begin_render_pass(uint32_t image_idx, const bool secondary_contents)
+    {
+        auto&       inst       = instance();
+        const auto& frame      = inst.frames[Frame::current_frame];
+        const auto& image      = inst.images[image_idx];
+        const auto& image_view = inst.image_views[image_idx];
+
         VkClearValue clear_color{ { 0.0f, 0.0f, 0.0f, 1.0f } };
 
         VkRenderingAttachmentInfoKHR color_attachment
@@ -153,7 +161,7 @@ namespace boza
         {
             .sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR,
             .pNext = nullptr,
-            .flags = 0,
+            .flags = secondary_contents ? VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT : 0u,
             .renderArea = { .offset = { 0, 0 }, .extent = inst.extent },
             .layerCount = 1,
             .viewMask = 0,
@@ -203,26 +211,79 @@ namespace boza
 
         inst.image_layouts[image_idx] = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
-        VkViewport viewport
+        // secondaries inherit neither, they set their own in begin_secondary()
+        if (!secondary_contents) inst.set_viewport_and_scissor(frame.command_buffer);
+
+        return true;
+    }
+
+    bool Swapchain::begin_secondary(const VkCommandBuffer command_buffer)
+    {
+        const auto& inst = instance();
+
+        const VkCommandBufferInheritanceRenderingInfo rendering_info
+        {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .viewMask = 0,
+            .colorAttachmentCount = 1,
+            .pColorAttachmentFormats = &inst.surface_format.format,
+            .depthAttachmentFormat = VK_FORMAT_UNDEFINED,
+            .stencilAttachmentFormat = VK_FORMAT_UNDEFINED,
+            .rasterizationSamples = VK_SAMPLE_COUNT_1_BIT
+        };
+
+        const VkCommandBufferInheritanceInfo inheritance_info
+        {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+            .pNext = &rendering_info,
+            .renderPass = nullptr,
+            .subpass = 0,
+            .framebuffer = nullptr,
+            .occlusionQueryEnable = VK_FALSE,
+            .queryFlags = 0,
+            .pipelineStatistics = 0
+        };
+
+        const VkCommandBufferBeginInfo begin_info
+        {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            .pNext = nullptr,
+            .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+            .pInheritanceInfo = &inheritance_info
+        };
+
+        VK_CHECK(vkBeginCommandBuffer(command_buffer, &begin_info),
+        {
+            LOG_VK_ERROR("Failed to begin secondary command buffer");
+            return false;
+        });
+
+        inst.set_viewport_and_scissor(command_buffer);
+        return true;
+    }
+
+    void Swapchain::set_viewport_and_scissor(const VkCommandBuffer command_buffer) const
+    {
+        const VkViewport viewport
         {
             .x = 0.0f,
             .y = 0.0f,
-            .width = static_cast<float>(inst.extent.width),
-            .height = static_cast<float>(inst.extent.height),
+            .width = static_cast<float>(extent.width),
+            .height = static_cast<float>(extent.height),
             .minDepth = 0.0f,
             .maxDepth = 1.0f
         };
 
-        VkRect2D scissor
+        const VkRect2D scissor
         {
             .offset = { 0, 0 },
-            .extent = inst.extent
+            .extent = extent
         };
 
-        vkCmdSetViewport(frame.command_buffer, 0, 1, &viewport);
-        vkCmdSetScissor(frame.command_buffer, 0, 1, &scissor);
-
-        return true;
+        vkCmdSetViewport(command_buffer, 0, 1, &viewport);
+        vkCmdSetScissor(command_buffer, 0, 1, &scissor);
     }
 
     bool Swapchain::end_render_pass(const uint32_t image_idx)
@@ -346,14 +407,29 @@ namespace boza
             image_available_semaphore,
             render_finished_semaphore] = inst.frames[Frame::current_frame];
 
-        VkSemaphoreSubmitInfo wait_semaphore_info
+        // the frame also waits for every staging upload flushed so far; no-op once the transfer queue has caught up
+        const std::array wait_semaphore_infos
         {
-            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
-            .pNext = nullptr,
-            .semaphore = image_available_semaphore,
-            .value = 0,
-            .stageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
-            .deviceIndex = 0
+            VkSemaphoreSubmitInfo
+            {
+                .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+                .pNext = nullptr,
+                .semaphore = image_available_semaphore,
+                .value = 0,
+                .stageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+                .deviceIndex = 0
+            },
+            VkSemaphoreSubmitInfo
+            {
+                .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+                .pNext = nullptr,
+                .semaphore = StagingRing::get_timeline_semaphore(),
+                .value = StagingRing::get_submitted_value(),
+                .stageMask = VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT |
+                             VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT |
+                             VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                .deviceIndex = 0
+            }
         };
 
         VkSemaphoreSubmitInfo signal_semaphore_info
@@ -379,8 +455,8 @@ namespace boza
             .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
             .pNext = nullptr,
             .flags = 0,
-            .waitSemaphoreInfoCount = 1,
-            .pWaitSemaphoreInfos = &wait_semaphore_info,
+            .waitSemaphoreInfoCount = static_cast<uint32_t>(wait_semaphore_infos.size()),
+            .pWaitSemaphoreInfos = wait_semaphore_infos.data(),
             .commandBufferInfoCount = 1,
             .pCommandBufferInfos = &cmd_submit_info,
             .signalSemaphoreInfoCount = 1,
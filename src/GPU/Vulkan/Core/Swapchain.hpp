@@ -16,7 +16,11 @@ namespace boza
         static bool create();
         static void destroy();
 
-        [[nodiscard]] static bool begin_render_pass(uint32_t image_idx);
+        // Resets and begins the frame's command buffer; work recorded before begin_render_pass runs outside the pass.
+        [[nodiscard]] static bool begin_command_buffer();
+        // With secondary_contents the pass may only execute secondary command buffers begun with begin_secondary().
+        [[nodiscard]] static bool begin_render_pass(uint32_t image_idx, bool secondary_contents = false);
+        [[nodiscard]] static bool begin_secondary(VkCommandBuffer command_buffer);
         [[nodiscard]] static bool end_render_pass(uint32_t image_idx);
         [[nodiscard]] static image_idx_t acquire_next_image();
         [[nodiscard]] static bool submit_and_present(uint32_t image_idx);
@@ -50,6 +54,8 @@ namespace boza
         [[nodiscard]] bool query_swapchain_support();
         [[nodiscard]] bool create_image_views();
 
+        void set_viewport_and_scissor(VkCommandBuffer command_buffer) const;
+
         [[nodiscard]] bool create_sync_objects();
         [[nodiscard]] bool create_command_buffers();
 
@@ -2,40 +2,242 @@
 
 #include "GPU/Vulkan/Core/Device.hpp"
 #include "Logger.hpp"
+#include "Profiler.hpp"
 
 namespace boza
 {
     bool DescriptorPool::create()
     {
-        std::array pool_sizes
+        auto& inst = instance();
+
+        // created up front so a broken device fails here rather than on the first draw
+        inst.persistent.current = next_pool(inst.persistent);
+        return inst.persistent.current != nullptr;
+    }
+
+    void DescriptorPool::destroy()
+    {
+        auto& inst = instance();
+
+        destroy(inst.persistent);
+        for (auto& chain : inst.frames)
+            destroy(chain);
+
+        inst.persistent_sets.clear();
+        for (auto& sets : inst.frame_sets)
+            sets.clear();
+        inst.unallocatable.clear();
+    }
+
+
+    bool DescriptorPool::begin_frame()
+    {
+        auto& inst = instance();
+
+        const uint32_t frame = Swapchain::current_frame_idx();
+        inst.frame_sets[frame].clear();
+        return reset(inst.frames[frame]);
+    }
+
+    VkDescriptorSet DescriptorPool::allocate(const VkDescriptorSetLayout layout, const DescriptorLifetime lifetime)
+    {
+        auto& inst = instance();
+
+        PoolChain& chain = lifetime == DescriptorLifetime::Persistent ? inst.persistent : inst.frames[Swapchain::current_frame_idx()];
+        return allocate_from(chain, layout);
+    }
+
+    VkDescriptorSet DescriptorPool::get_set(
+        const VkDescriptorSetLayout            layout,
+        const std::span<const DescriptorWrite> writes,
+        const DescriptorLifetime               lifetime)
+    {
+        BOZA_PROFILE_FUNCTION();
+
+        auto& inst = instance();
+
+        std::string key;
+        key.reserve(sizeof(layout) + writes.size() * sizeof(DescriptorWrite));
+        key.append(reinterpret_cast<const char*>(&layout), sizeof(layout));
+        for (const auto& write : writes)
+        {
+            // field by field, the struct has padding
+            key.append(reinterpret_cast<const char*>(&write.binding), sizeof(write.binding));
+            key.append(reinterpret_cast<const char*>(&write.type), sizeof(write.type));
+            key.append(reinterpret_cast<const char*>(&write.buffer.buffer), sizeof(write.buffer.buffer));
+            key.append(reinterpret_cast<const char*>(&write.buffer.offset), sizeof(write.buffer.offset));
+            key.append(reinterpret_cast<const char*>(&write.buffer.range), sizeof(write.buffer.range));
+            key.append(reinterpret_cast<const char*>(&write.image.sampler), sizeof(write.image.sampler));
+            key.append(reinterpret_cast<const char*>(&write.image.imageView), sizeof(write.image.imageView));
+            key.append(reinterpret_cast<const char*>(&write.image.imageLayout), sizeof(write.image.imageLayout));
+        }
+
+        SetCache& cache = lifetime == DescriptorLifetime::Persistent ? inst.persistent_sets : inst.frame_sets[Swapchain::current_frame_idx()];
+        if (const auto it = cache.find(key); it != cache.end()) return it->second;
+
+        const VkDescriptorSet set = allocate(layout, lifetime);
+        if (set == nullptr) return nullptr;
+
+        std::vector<VkWriteDescriptorSet> descriptor_writes;
+        descriptor_writes.reserve(writes.size());
+
+        for (const auto& write : writes)
         {
-            VkDescriptorPoolSize{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 10 },
-            VkDescriptorPoolSize{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 10 }
+            const bool image = write.type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER
+                            || write.type == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE
+                            || write.type == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE
+                            || write.type == VK_DESCRIPTOR_TYPE_SAMPLER;
+
+            descriptor_writes.push_back({
+                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                .dstSet = set,
+                .dstBinding = write.binding,
+                .dstArrayElement = 0,
+                .descriptorCount = 1,
+                .descriptorType = write.type,
+                .pImageInfo = image ? &write.image : nullptr,
+                .pBufferInfo = image ? nullptr : &write.buffer,
+                .pTexelBufferView = nullptr
+            });
+        }
+
+        vkUpdateDescriptorSets(
+            Device::get_device(),
+            static_cast<uint32_t>(descriptor_writes.size()),
+            descriptor_writes.data(),
+            0,
+            nullptr);
+
+        cache.try_emplace(std::move(key), set);
+        return set;
+    }
+
+
+    VkDescriptorSet DescriptorPool::allocate_from(PoolChain& chain, const VkDescriptorSetLayout layout)
+    {
+        auto& inst = instance();
+        if (inst.unallocatable.contains(layout)) return nullptr;
+
+        if (chain.current == nullptr)
+        {
+            chain.current = next_pool(chain);
+            if (chain.current == nullptr) return nullptr;
+        }
+
+        VkDescriptorSetAllocateInfo alloc_info
+        {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+            .pNext = nullptr,
+            .descriptorPool = chain.current,
+            .descriptorSetCount = 1,
+            .pSetLayouts = &layout
         };
 
+        VkDescriptorSet set{ nullptr };
+        const VkResult result = vkAllocateDescriptorSets(Device::get_device(), &alloc_info, &set);
+        if (result == VK_SUCCESS) return set;
+
+        if (result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL)
+        {
+            LOG_VK_ERROR("Failed to allocate descriptor set");
+            return nullptr;
+        }
+
+        const VkDescriptorPool fresh = next_pool(chain);
+        if (fresh == nullptr) return nullptr;
+
+        alloc_info.descriptorPool = fresh;
+        VK_CHECK(vkAllocateDescriptorSets(Device::get_device(), &alloc_info, &set),
+        {
+            chain.ready.push_back(fresh);
+            if (result != VK_ERROR_OUT_OF_POOL_MEMORY)
+            {
+                LOG_VK_ERROR("Failed to allocate descriptor set from a fresh pool");
+                return nullptr;
+            }
+
+            // the layout needs more than any pool provides; growing further would not help
+            inst.unallocatable.insert(layout);
+            LOG_VK_ERROR("Descriptor set layout does not fit an empty pool");
+            return nullptr;
+        });
+
+        chain.full.push_back(chain.current);
+        chain.current = fresh;
+        return set;
+    }
+
+    VkDescriptorPool DescriptorPool::next_pool(PoolChain& chain)
+    {
+        if (!chain.ready.empty())
+        {
+            const VkDescriptorPool pool = chain.ready.back();
+            chain.ready.pop_back();
+            return pool;
+        }
+
+        const uint32_t set_count = chain.sets_per_pool;
+
+        std::array<VkDescriptorPoolSize, pool_ratios.size()> pool_sizes{};
+        for (size_t i = 0; i < pool_ratios.size(); ++i)
+        {
+            const auto [type, ratio] = pool_ratios[i];
+            pool_sizes[i] = { type, static_cast<uint32_t>(ratio * static_cast<float>(set_count)) };
+        }
+
         const VkDescriptorPoolCreateInfo descriptor_pool_info
         {
             .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
             .pNext = nullptr,
             .flags = {},
-            .maxSets = 10,
+            .maxSets = set_count,
             .poolSizeCount = static_cast<uint32_t>(pool_sizes.size()),
             .pPoolSizes = pool_sizes.data()
         };
 
-        VK_CHECK(vkCreateDescriptorPool(Device::get_device(), &descriptor_pool_info, nullptr, &instance().descriptor_pool),
+        VkDescriptorPool pool{ nullptr };
+        VK_CHECK(vkCreateDescriptorPool(Device::get_device(), &descriptor_pool_info, nullptr, &pool),
         {
             LOG_VK_ERROR("Failed to create descriptor pool");
-            return false;
+            return nullptr;
         });
 
-        return true;
+        // each pool added to a chain is larger than the last, so busy chains settle on a few big pools
+        chain.sets_per_pool = std::min(set_count * 2, max_sets_per_pool);
+
+        Logger::debug("Created descriptor pool for {} sets", set_count);
+        return pool;
     }
 
-    void DescriptorPool::destroy()
+    bool DescriptorPool::reset(PoolChain& chain)
     {
-        vkDestroyDescriptorPool(Device::get_device(), instance().descriptor_pool, nullptr);
+        if (chain.current != nullptr) chain.full.push_back(chain.current);
+        chain.current = nullptr;
+
+        for (const auto pool : chain.full)
+        {
+            VK_CHECK(vkResetDescriptorPool(Device::get_device(), pool, 0),
+            {
+                LOG_VK_ERROR("Failed to reset descriptor pool");
+                return false;
+            });
+        }
+
+        chain.ready.insert(chain.ready.end(), chain.full.begin(), chain.full.end());
+        chain.full.clear();
+
+        return true;
     }
 
-    VkDescriptorPool& DescriptorPool::get_descriptor_pool() { return instance().descriptor_pool; }
+    void DescriptorPool::destroy(PoolChain& chain)
+    {
+        // destroying a pool frees its sets
+        if (chain.current != nullptr) vkDestroyDescriptorPool(Device::get_device(), chain.current, nullptr);
+        for (const auto pool : chain.full)
+            vkDestroyDescriptorPool(Device::get_device(), pool, nullptr);
+        for (const auto pool : chain.ready)
+            vkDestroyDescriptorPool(Device::get_device(), pool, nullptr);
+
+        chain = {};
+    }
 }
@@ -1,9 +1,30 @@
 #pragma once
 #include "boza_pch.hpp"
 #include "Singleton.hpp"
+#include "GPU/Vulkan/Core/Swapchain.hpp"
 
 namespace boza
 {
+    enum class DescriptorLifetime : uint8_t
+    {
+        // lives until the allocator is destroyed
+        Persistent,
+        // only valid until the same frame index comes around again
+        Frame
+    };
+
+    // The contents of one binding; buffer or image is read depending on type.
+    struct DescriptorWrite
+    {
+        uint32_t               binding;
+        VkDescriptorType       type;
+        VkDescriptorBufferInfo buffer{};
+        VkDescriptorImageInfo  image{};
+    };
+
+    // Descriptor set allocator backed by chains of pools, one for persistent sets and one per frame in flight. A
+    // chain adds a larger pool whenever its current one runs out, and frame chains are reset in bulk instead of
+    // freeing sets one by one. Render thread only.
     class DescriptorPool final : public Singleton<DescriptorPool>
     {
     public:
@@ -11,10 +32,60 @@ namespace boza
         static bool create();
         static void destroy();
 
-        [[nodiscard]] static VkDescriptorPool& get_descriptor_pool();
+        // Resets the current frame's pools and set cache; call after Swapchain::acquire_next_image has waited on
+        // its fence.
+        [[nodiscard]] static bool begin_frame();
+
+        // An unwritten set, nullptr on failure.
+        [[nodiscard]] static VkDescriptorSet allocate(VkDescriptorSetLayout layout, DescriptorLifetime lifetime = DescriptorLifetime::Persistent);
+
+        // A set with writes applied, shared with every earlier request for the same layout and contents in the same
+        // lifetime. Cached persistent sets are never rewritten, so what they reference must outlive the allocator.
+        [[nodiscard]] static VkDescriptorSet get_set(
+            VkDescriptorSetLayout            layout,
+            std::span<const DescriptorWrite> writes,
+            DescriptorLifetime               lifetime = DescriptorLifetime::Frame);
 
     private:
-        VkDescriptorPool descriptor_pool{ nullptr };
+        static constexpr uint32_t initial_sets_per_pool = 64;
+        static constexpr uint32_t max_sets_per_pool     = 4096;
+
+        // descriptors of each type reserved per set; covers every type ShaderLoader reflects and get_set writes
+        static constexpr std::array<std::pair<VkDescriptorType, float>, 7> pool_ratios
+        {{
+            { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,         1.0f },
+            { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 2.0f },
+            { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,         2.0f },
+            { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4.0f },
+            { VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,          2.0f },
+            { VK_DESCRIPTOR_TYPE_SAMPLER,                1.0f },
+            { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,          1.0f }
+        }};
+
+        struct PoolChain
+        {
+            VkDescriptorPool              current{ nullptr };
+            // exhausted since the last reset
+            std::vector<VkDescriptorPool> full;
+            // reset and waiting to be reused
+            std::vector<VkDescriptorPool> ready;
+            uint32_t                      sets_per_pool{ initial_sets_per_pool };
+        };
+
+        static VkDescriptorSet  allocate_from(PoolChain& chain, VkDescriptorSetLayout layout);
+        static VkDescriptorPool next_pool(PoolChain& chain);
+        static bool             reset(PoolChain& chain);
+        static void             destroy(PoolChain& chain);
+
+        // keyed by the layout and the raw bytes of the writes
+        using SetCache = hash_map<std::string, VkDescriptorSet>;
+
+        PoolChain                                              persistent{};
+        std::array<PoolChain, Swapchain::max_frames_in_flight> frames{};
+        SetCache                                               persistent_sets;
+        std::array<SetCache, Swapchain::max_frames_in_flight>  frame_sets{};
+        // layouts that did not fit even an empty pool, failed without retrying
+        hash_set<VkDescriptorSetLayout>                        unallocatable;
 
         friend Singleton;
         DescriptorPool() = default;
@@ -1,5 +1,6 @@
 #include "DescriptorSet.hpp"
 #include "GPU/Vulkan/Core/Device.hpp"
+#include "GPU/Vulkan/Memory/UniformRing.hpp"
 #include "Logger.hpp"
 
 namespace boza
@@ -53,20 +54,9 @@ namespace boza
 
         for (uint32_t i = 0; i < Swapchain::max_frames_in_flight; ++i)
         {
-            VkDescriptorSetAllocateInfo alloc_info
-            {
-                .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
-                .pNext = nullptr,
-                .descriptorPool = DescriptorPool::get_descriptor_pool(),
-                .descriptorSetCount = 1,
-                .pSetLayouts = &layout
-            };
-
-            VK_CHECK(vkAllocateDescriptorSets(Device::get_device(), &alloc_info, &descriptor_sets[i]),
-            {
-                LOG_VK_ERROR("Failed to allocate descriptor set");
-                return false;
-            });
+            // rewritten in place, so they must outlive the frame
+            descriptor_sets[i] = DescriptorPool::allocate(layout, DescriptorLifetime::Persistent);
+            if (descriptor_sets[i] == nullptr) return false;
 
             update_descriptor_set(i);
         }
@@ -76,13 +66,6 @@ namespace boza
 
     void DescriptorSet::destroy()
     {
-        for (auto& buffer_group : buffers)
-        {
-            for (auto& buffer : buffer_group)
-                buffer.destroy();
-        }
-        buffers.clear();
-
         if (layout != nullptr)
         {
             vkDestroyDescriptorSetLayout(Device::get_device(), layout, nullptr);
@@ -93,7 +76,7 @@ namespace boza
 
     descriptor_set_binding DescriptorSet::add_image_sampler(const VkShaderStageFlags stage_flags)
     {
-        const auto binding = static_cast<descriptor_set_binding>(buffer_infos.size() + image_infos.size());
+        const auto binding = static_cast<descriptor_set_binding>(buffer_indices.size());
 
         const ImageInfo info
         {
@@ -104,13 +87,14 @@ namespace boza
             .binding = binding
         };
 
+        buffer_indices.push_back(INVALID_BUFFER_INDEX);
         image_infos.push_back(info);
         return binding;
     }
 
     void DescriptorSet::update_image_sampler(const descriptor_set_binding binding, Texture& texture)
     {
-        if (binding >= buffer_infos.size() + image_infos.size()) return;
+        if (binding >= buffer_indices.size()) return;
 
         for (auto& image_info : image_infos)
         {
@@ -127,8 +111,35 @@ namespace boza
     }
 
 
-    VkDescriptorSet&       DescriptorSet::get_descriptor_set() { return descriptor_sets[Swapchain::current_frame_idx()]; }
-    VkDescriptorSetLayout& DescriptorSet::get_layout() { return layout; }
+    bool DescriptorSet::write_buffer(const descriptor_set_binding binding, const void* data, const VkDeviceSize size)
+    {
+        if (binding >= buffer_indices.size() || buffer_indices[binding] == INVALID_BUFFER_INDEX) return false;
+
+        const uint32_t dynamic_index = buffer_infos[buffer_indices[binding]].dynamic_index;
+
+        const auto offset = UniformRing::write(data, size);
+        if (!offset) return false;
+
+        dynamic_offsets[dynamic_index] = *offset;
+        return true;
+    }
+
+    void DescriptorSet::bind(const VkCommandBuffer command_buffer, const VkPipelineLayout pipeline_layout, const uint32_t set_index)
+    {
+        vkCmdBindDescriptorSets(
+            command_buffer,
+            VK_PIPELINE_BIND_POINT_GRAPHICS,
+            pipeline_layout,
+            set_index, 1,
+            &get_descriptor_set(),
+            static_cast<uint32_t>(dynamic_offsets.size()),
+            dynamic_offsets.data());
+    }
+
+
+    VkDescriptorSet&          DescriptorSet::get_descriptor_set() { return descriptor_sets[Swapchain::current_frame_idx()]; }
+    VkDescriptorSetLayout&    DescriptorSet::get_layout() { return layout; }
+    std::span<const uint32_t> DescriptorSet::get_dynamic_offsets() const { return dynamic_offsets; }
 
     void DescriptorSet::update_descriptor_set(const uint32_t frame_index) const
     {
@@ -136,14 +147,14 @@ namespace boza
         std::vector<VkDescriptorBufferInfo> buffer_descriptor_infos;
         std::vector<VkDescriptorImageInfo> image_descriptor_infos;
 
-        buffer_descriptor_infos.resize(buffers.size());
+        buffer_descriptor_infos.resize(buffer_infos.size());
         image_descriptor_infos.resize(image_infos.size());
 
-        for (uint32_t i = 0; i < buffers.size(); ++i)
+        for (uint32_t i = 0; i < buffer_infos.size(); ++i)
         {
             buffer_descriptor_infos[i] =
             {
-                .buffer = buffers[i][frame_index].get_buffer(),
+                .buffer = UniformRing::get_buffer(),
                 .offset = 0,
                 .range = buffer_infos[i].size,
             };
@@ -3,6 +3,7 @@
 
 #include "GPU/Vulkan/Memory/Buffer.hpp"
 #include "GPU/Vulkan/Memory/Texture.hpp"
+#include "GPU/Vulkan/Core/Swapchain.hpp"
 
 namespace boza
 {
@@ -15,14 +16,19 @@ namespace boza
         bool create();
         void destroy();
 
+        // Uniform buffers are dynamic bindings into the UniformRing; data written by update_buffer
+        // lives for the current frame only and takes effect with the next bind().
         template<typename T> descriptor_set_binding add_uniform_buffer(VkShaderStageFlags stage_flags);
-        template<typename T> void update_buffer(descriptor_set_binding binding, const T& data);
+        template<typename T> bool update_buffer(descriptor_set_binding binding, const T& data);
 
         descriptor_set_binding add_image_sampler(VkShaderStageFlags stage_flags);
         void update_image_sampler(descriptor_set_binding binding, Texture& texture);
 
+        void bind(VkCommandBuffer command_buffer, VkPipelineLayout pipeline_layout, uint32_t set_index = 0);
+
         VkDescriptorSet& get_descriptor_set();
         VkDescriptorSetLayout& get_layout();
+        std::span<const uint32_t> get_dynamic_offsets() const;
 
     private:
         struct BufferInfo
@@ -31,6 +37,8 @@ namespace boza
             VkDescriptorType       type;
             VkShaderStageFlags     stage_flags;
             descriptor_set_binding binding;
+            // index into dynamic_offsets
+            uint32_t               dynamic_index;
         };
 
         struct ImageInfo
@@ -42,12 +50,18 @@ namespace boza
             descriptor_set_binding binding;
         };
 
+        static constexpr uint32_t INVALID_BUFFER_INDEX = std::numeric_limits<uint32_t>::max();
+
+        bool write_buffer(descriptor_set_binding binding, const void* data, VkDeviceSize size);
         void update_descriptor_set(uint32_t frame_index) const;
 
-        std::vector<std::vector<Buffer>> buffers;
-        std::vector<BufferInfo>          buffer_infos;
-        std::vector<ImageInfo>           image_infos;
-        std::vector<VkDescriptorSet>     descriptor_sets;
+        std::vector<BufferInfo>      buffer_infos;
+        // one per dynamic binding, in binding order as vkCmdBindDescriptorSets expects
+        std::vector<uint32_t>        dynamic_offsets;
+        // binding -> index into buffer_infos
+        std::vector<uint32_t>        buffer_indices;
+        std::vector<ImageInfo>       image_infos;
+        std::vector<VkDescriptorSet> descriptor_sets;
 
         VkDescriptorSetLayout layout{ nullptr };
     };
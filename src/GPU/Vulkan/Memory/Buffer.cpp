@@ -1,6 +1,7 @@
 #include "Buffer.hpp"
 
 #include "Allocator.hpp"
+#include "GPU/Vulkan/Core/Device.hpp"
 #include "Logger.hpp"
 
 namespace boza
@@ -31,6 +32,11 @@ namespace boza
     {
         Buffer buffer;
 
+        // upload targets are written by the transfer queue and read by the graphics queue
+        const auto& families = Device::get_queue_family_indices();
+        const std::array queue_family_indices{ families.graphics_family, families.transfer_family };
+        const bool concurrent = (usage & VK_BUFFER_USAGE_TRANSFER_DST_BIT) && queue_family_indices[0] != queue_family_indices[1];
+
         const VkBufferCreateInfo buffer_info
         {
             .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
@@ -38,7 +44,9 @@ namespace boza
             .flags = 0,
             .size = size,
             .usage = usage,
-            .sharingMode = VK_SHARING_MODE_EXCLUSIVE
+            .sharingMode = concurrent ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE,
+            .queueFamilyIndexCount = concurrent ? 2u : 0u,
+            .pQueueFamilyIndices = queue_family_indices.data()
         };
 
         const VmaAllocationCreateInfo allocation_info
@@ -65,13 +73,14 @@ namespace boza
 
 
     Buffer Buffer::create_uniform_buffer(const VkDeviceSize size) { return create(size, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU); }
-    Buffer Buffer::create_vertex_buffer(const VkDeviceSize size) { return create(size, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU); }
-    Buffer Buffer::create_index_buffer(const VkDeviceSize size) { return create(size, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU); }
+    Buffer Buffer::create_vertex_buffer(const VkDeviceSize size) { return create(size, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY); }
+    Buffer Buffer::create_index_buffer(const VkDeviceSize size) { return create(size, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY); }
     Buffer Buffer::create_staging_buffer(const VkDeviceSize size) { return create(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY); }
     Buffer Buffer::create_storage_buffer(const VkDeviceSize size) { return create(size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY); }
 
     VkBuffer      Buffer::get_buffer() const { return buffer; }
     VmaAllocation Buffer::get_allocation() const { return allocation; }
+    void*         Buffer::get_mapped_data() const { return allocation_info.pMappedData; }
 
 
     void Buffer::destroy()
@@ -92,6 +101,6 @@ namespace boza
 
     void Buffer::write(const void* data, const VkDeviceSize size, const VkDeviceSize offset) const
     {
-        memcpy(allocation_info.pMappedData, static_cast<const char*>(data) + offset, size);
+        memcpy(static_cast<char*>(allocation_info.pMappedData) + offset, data, size);
     }
 }
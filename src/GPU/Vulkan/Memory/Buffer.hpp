@@ -32,6 +32,7 @@ namespace boza
 
         [[nodiscard]] VkBuffer      get_buffer() const;
         [[nodiscard]] VmaAllocation get_allocation() const;
+        [[nodiscard]] void*         get_mapped_data() const;
 
     private:
         VkBuffer buffer{ nullptr };
@@ -0,0 +1,176 @@
+#include "OffsetAllocator.hpp"
+
+namespace boza
+{
+    OffsetAllocator::OffsetAllocator(const uint32_t size) : size{ size }, free_space{ size }
+    {
+        bin_heads.fill(INVALID_NODE);
+        if (size != 0) insert_free(create_node(0, size));
+    }
+
+
+    std::optional<OffsetAllocator::Allocation> OffsetAllocator::allocate(const uint32_t size)
+    {
+        if (size == 0 || size > free_space) return std::nullopt;
+
+        const uint32_t min_bin = bin_round_up(size);
+        uint32_t       top     = min_bin / leaf_bins;
+        uint32_t       leaf    = min_bin % leaf_bins;
+
+        if (top >= top_bins) return std::nullopt;
+
+        // any block in a bin at or above min_bin is large enough
+        const uint32_t leaf_mask = (used_top_bins & 1u << top) ? used_leaf_bins[top] & ~0u << leaf : 0u;
+        if (leaf_mask != 0) leaf = std::countr_zero(leaf_mask);
+        else
+        {
+            const uint32_t top_mask = top + 1 < 32 ? used_top_bins & ~0u << (top + 1) : 0u;
+            if (top_mask == 0) return std::nullopt;
+
+            top  = std::countr_zero(top_mask);
+            leaf = std::countr_zero(static_cast<uint32_t>(used_leaf_bins[top]));
+        }
+
+        const uint32_t index = bin_heads[top * leaf_bins + leaf];
+        remove_free(index);
+
+        Node& node = nodes[index];
+        node.used = true;
+
+        if (const uint32_t remainder = node.size - size; remainder != 0)
+        {
+            node.size = size;
+
+            const uint32_t split = create_node(nodes[index].offset + size, remainder);
+            Node&          rest  = nodes[split];
+            Node&          used  = nodes[index];
+
+            rest.neighbor_prev = index;
+            rest.neighbor_next = used.neighbor_next;
+            if (used.neighbor_next != INVALID_NODE) nodes[used.neighbor_next].neighbor_prev = split;
+            used.neighbor_next = split;
+
+            insert_free(split);
+        }
+
+        free_space -= size;
+        return Allocation{ nodes[index].offset, index };
+    }
+
+    void OffsetAllocator::free(const Allocation& allocation)
+    {
+        assert(allocation.node < nodes.size() && nodes[allocation.node].used && "Freeing an allocation twice");
+
+        uint32_t index = allocation.node;
+        nodes[index].used = false;
+        free_space += nodes[index].size;
+
+        if (const uint32_t prev = nodes[index].neighbor_prev; prev != INVALID_NODE && !nodes[prev].used)
+        {
+            remove_free(prev);
+
+            nodes[prev].size += nodes[index].size;
+            nodes[prev].neighbor_next = nodes[index].neighbor_next;
+            if (nodes[index].neighbor_next != INVALID_NODE) nodes[nodes[index].neighbor_next].neighbor_prev = prev;
+
+            unused_nodes.push_back(index);
+            index = prev;
+        }
+
+        if (const uint32_t next = nodes[index].neighbor_next; next != INVALID_NODE && !nodes[next].used)
+        {
+            remove_free(next);
+
+            nodes[index].size += nodes[next].size;
+            nodes[index].neighbor_next = nodes[next].neighbor_next;
+            if (nodes[next].neighbor_next != INVALID_NODE) nodes[nodes[next].neighbor_next].neighbor_prev = index;
+
+            unused_nodes.push_back(next);
+        }
+
+        insert_free(index);
+    }
+
+    uint32_t OffsetAllocator::get_size() const { return size; }
+    uint32_t OffsetAllocator::get_free_space() const { return free_space; }
+
+    uint32_t OffsetAllocator::round_up_size(const uint32_t size)
+    {
+        if (size < mantissa_value) return size;
+
+        // clear the bits below the mantissa, carrying into it when any were set
+        const uint32_t shift = std::bit_width(size) - 1 - mantissa_bits;
+        const uint32_t low   = (1u << shift) - 1;
+        return size & low ? (size | low) + 1 : size;
+    }
+
+
+    uint32_t OffsetAllocator::bin_round_down(const uint32_t size)
+    {
+        if (size < mantissa_value) return size;
+
+        const uint32_t shift    = std::bit_width(size) - 1 - mantissa_bits;
+        const uint32_t mantissa = size >> shift & (mantissa_value - 1);
+        return (shift + 1) << mantissa_bits | mantissa;
+    }
+
+    uint32_t OffsetAllocator::bin_round_up(const uint32_t size)
+    {
+        if (size < mantissa_value) return size;
+
+        const uint32_t shift = std::bit_width(size) - 1 - mantissa_bits;
+        const uint32_t bin   = bin_round_down(size);
+
+        // a mantissa overflow carries into the exponent, which is still the right bin
+        return size & ((1u << shift) - 1) ? bin + 1 : bin;
+    }
+
+
+    uint32_t OffsetAllocator::create_node(const uint32_t offset, const uint32_t size)
+    {
+        uint32_t index;
+        if (!unused_nodes.empty())
+        {
+            index = unused_nodes.back();
+            unused_nodes.pop_back();
+        }
+        else
+        {
+            index = static_cast<uint32_t>(nodes.size());
+            nodes.emplace_back();
+        }
+
+        nodes[index] = { .offset = offset, .size = size };
+        return index;
+    }
+
+    void OffsetAllocator::insert_free(const uint32_t node)
+    {
+        const uint32_t bin  = bin_round_down(nodes[node].size);
+        const uint32_t head = bin_heads[bin];
+
+        nodes[node].bin_prev = INVALID_NODE;
+        nodes[node].bin_next = head;
+        if (head != INVALID_NODE) nodes[head].bin_prev = node;
+        bin_heads[bin] = node;
+
+        used_leaf_bins[bin / leaf_bins] |= static_cast<uint8_t>(1u << bin % leaf_bins);
+        used_top_bins |= 1u << bin / leaf_bins;
+    }
+
+    void OffsetAllocator::remove_free(const uint32_t node)
+    {
+        const Node& n = nodes[node];
+
+        if (n.bin_prev != INVALID_NODE) nodes[n.bin_prev].bin_next = n.bin_next;
+        if (n.bin_next != INVALID_NODE) nodes[n.bin_next].bin_prev = n.bin_prev;
+        if (n.bin_prev != INVALID_NODE) return;
+
+        const uint32_t bin = bin_round_down(n.size);
+        bin_heads[bin] = n.bin_next;
+        if (n.bin_next != INVALID_NODE) return;
+
+        used_leaf_bins[bin / leaf_bins] &= static_cast<uint8_t>(~(1u << bin % leaf_bins));
+        if (used_leaf_bins[bin / leaf_bins] == 0) used_top_bins &= ~(1u << bin / leaf_bins);
+    }
+}
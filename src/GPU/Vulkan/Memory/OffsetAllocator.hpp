@@ -0,0 +1,68 @@
+#pragma once
+#include "boza_pch.hpp"
+
+namespace boza
+{
+    // Two-level segregated-fit allocator over an abstract range of units (bytes, vertices, indices...).
+    // It only hands out offsets; the memory itself lives elsewhere. Free blocks are binned by a
+    // 3-bit-mantissa float of their size, so allocate and free are O(1) and neighbours coalesce on free.
+    class OffsetAllocator final
+    {
+    public:
+        struct Allocation
+        {
+            uint32_t offset{ INVALID_NODE };
+            uint32_t node{ INVALID_NODE };
+        };
+
+        static constexpr uint32_t INVALID_NODE = std::numeric_limits<uint32_t>::max();
+
+        OffsetAllocator() = default;
+        explicit OffsetAllocator(uint32_t size);
+
+        [[nodiscard]] std::optional<Allocation> allocate(uint32_t size);
+        void                                    free(const Allocation& allocation);
+
+        [[nodiscard]] uint32_t get_size() const;
+        [[nodiscard]] uint32_t get_free_space() const;
+
+        // Smallest size >= size whose free block is binned exactly, so a fresh allocator of that size can serve
+        // an allocation of size in one piece.
+        [[nodiscard]] static uint32_t round_up_size(uint32_t size);
+
+    private:
+        static constexpr uint32_t mantissa_bits  = 3;
+        static constexpr uint32_t mantissa_value = 1 << mantissa_bits;
+        static constexpr uint32_t leaf_bins      = mantissa_value;
+        static constexpr uint32_t top_bins       = 30;
+        static constexpr uint32_t bin_count      = top_bins * leaf_bins;
+
+        struct Node
+        {
+            uint32_t offset{ 0 };
+            uint32_t size{ 0 };
+            uint32_t bin_prev{ INVALID_NODE };
+            uint32_t bin_next{ INVALID_NODE };
+            uint32_t neighbor_prev{ INVALID_NODE };
+            uint32_t neighbor_next{ INVALID_NODE };
+            bool     used{ false };
+        };
+
+        [[nodiscard]] static uint32_t bin_round_down(uint32_t size);
+        [[nodiscard]] static uint32_t bin_round_up(uint32_t size);
+
+        [[nodiscard]] uint32_t create_node(uint32_t offset, uint32_t size);
+        void                   insert_free(uint32_t node);
+        void                   remove_free(uint32_t node);
+
+        std::vector<Node>     nodes;
+        std::vector<uint32_t> unused_nodes;
+
+        std::array<uint32_t, bin_count> bin_heads{};
+        std::array<uint8_t, top_bins>   used_leaf_bins{};
+        uint32_t                        used_top_bins{ 0 };
+
+        uint32_t size{ 0 };
+        uint32_t free_space{ 0 };
+    };
+}
@@ -0,0 +1,488 @@
+#include "StagingRing.hpp"
+
+#include "GPU/Vulkan/Core/Device.hpp"
+#include "Logger.hpp"
+
+namespace boza
+{
+    bool StagingRing::create(const VkDeviceSize capacity)
+    {
+        auto& inst = instance();
+
+        inst.ring = Buffer::create_staging_buffer(capacity);
+        if (inst.ring.get_buffer() == nullptr)
+        {
+            Logger::critical("Failed to create staging ring buffer");
+            return false;
+        }
+
+        inst.mapped   = static_cast<std::byte*>(inst.ring.get_mapped_data());
+        inst.capacity = capacity;
+
+        const VkCommandPoolCreateInfo pool_info
+        {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+            .queueFamilyIndex = Device::get_queue_family_indices().transfer_family
+        };
+
+        VK_CHECK(vkCreateCommandPool(Device::get_device(), &pool_info, nullptr, &inst.command_pool),
+        {
+            LOG_VK_ERROR("Failed to create staging command pool");
+            return false;
+        });
+
+        for (auto& batch : inst.batches)
+        {
+            const VkCommandBufferAllocateInfo alloc_info
+            {
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+                .pNext = nullptr,
+                .commandPool = inst.command_pool,
+                .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+                .commandBufferCount = 1
+            };
+
+            VK_CHECK(vkAllocateCommandBuffers(Device::get_device(), &alloc_info, &batch.command_buffer),
+            {
+                LOG_VK_ERROR("Failed to allocate staging command buffer");
+                return false;
+            });
+        }
+
+        constexpr VkSemaphoreTypeCreateInfo type_info
+        {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+            .pNext = nullptr,
+            .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+            .initialValue = 0
+        };
+
+        const VkSemaphoreCreateInfo semaphore_info
+        {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+            .pNext = &type_info,
+            .flags = 0
+        };
+
+        VK_CHECK(vkCreateSemaphore(Device::get_device(), &semaphore_info, nullptr, &inst.timeline),
+        {
+            LOG_VK_ERROR("Failed to create staging timeline semaphore");
+            return false;
+        });
+
+        return true;
+    }
+
+    void StagingRing::destroy()
+    {
+        auto& inst = instance();
+        if (!wait_idle()) Logger::error("Failed to wait for pending staging copies");
+
+        inst.batches.fill({});
+
+        if (inst.timeline != nullptr)
+        {
+            vkDestroySemaphore(Device::get_device(), inst.timeline, nullptr);
+            inst.timeline = nullptr;
+        }
+
+        if (inst.command_pool != nullptr)
+        {
+            vkDestroyCommandPool(Device::get_device(), inst.command_pool, nullptr);
+            inst.command_pool = nullptr;
+        }
+
+        inst.ring.destroy();
+        inst.mapped = nullptr;
+        inst.pending.clear();
+        inst.pending_images.clear();
+        inst.in_flight.clear();
+        inst.head = inst.used = inst.pending_bytes = 0;
+        inst.submitted_value = 0;
+    }
+
+
+    bool StagingRing::upload(const VkBuffer destination, const void* data, const VkDeviceSize size, const VkDeviceSize offset)
+    {
+        auto& inst = instance();
+
+        // large uploads are streamed through the ring in pieces so they never need all of it at once
+        const VkDeviceSize max_chunk = inst.capacity / 4;
+
+        for (VkDeviceSize done = 0; done < size;)
+        {
+            const VkDeviceSize chunk = std::min(max_chunk, size - done);
+
+            const auto src_offset = inst.allocate_or_wait(chunk);
+            if (!src_offset) return false;
+
+            memcpy(inst.mapped + *src_offset, static_cast<const std::byte*>(data) + done, chunk);
+
+            inst.pending.push_back({
+                .destination = destination,
+                .region = {
+                    .srcOffset = *src_offset,
+                    .dstOffset = offset + done,
+                    .size = chunk
+                }
+            });
+
+            done += chunk;
+        }
+
+        return true;
+    }
+
+    bool StagingRing::upload_image(
+        const VkImage  destination,
+        const void*    data,
+        const uint32_t width,
+        const uint32_t height,
+        const uint32_t texel_size)
+    {
+        auto& inst = instance();
+
+        // chunks are whole rows, so a large image can still stream through the ring
+        const VkDeviceSize row_pitch   = static_cast<VkDeviceSize>(width) * texel_size;
+        const VkDeviceSize max_chunk   = inst.capacity / 4;
+        const VkExtent3D&  granularity = Device::get_transfer_granularity();
+
+        // partial copies must start on a multiple of the transfer queue's granularity; a zero granularity only
+        // allows the whole image at once
+        uint32_t rows_per_chunk = height;
+        if (granularity.height != 0)
+        {
+            rows_per_chunk = static_cast<uint32_t>(std::min<VkDeviceSize>(height, max_chunk / row_pitch));
+            if (rows_per_chunk < height) rows_per_chunk -= rows_per_chunk % granularity.height;
+        }
+
+        if (rows_per_chunk == 0 || rows_per_chunk * row_pitch > inst.capacity)
+        {
+            Logger::error("Image of {}x{} texels cannot be split to fit the staging ring", width, height);
+            return false;
+        }
+
+        const VkDeviceSize texel_align = std::lcm(alignment, static_cast<VkDeviceSize>(texel_size));
+
+        for (uint32_t row = 0; row < height;)
+        {
+            const uint32_t     rows  = std::min(rows_per_chunk, height - row);
+            const VkDeviceSize chunk = rows * row_pitch;
+
+            const auto src_offset = inst.allocate_or_wait(chunk, texel_align);
+            if (!src_offset) return false;
+
+            memcpy(inst.mapped + *src_offset, static_cast<const std::byte*>(data) + row * row_pitch, chunk);
+
+            inst.pending_images.push_back({
+                .destination = destination,
+                .old_layout = row == 0 ? VK_IMAGE_LAYOUT_UNDEFINED : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                .region = {
+                    .bufferOffset = *src_offset,
+                    .bufferRowLength = 0,
+                    .bufferImageHeight = 0,
+                    .imageSubresource = {
+                        .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                        .mipLevel = 0,
+                        .baseArrayLayer = 0,
+                        .layerCount = 1
+                    },
+                    .imageOffset = { .x = 0, .y = static_cast<int32_t>(row), .z = 0 },
+                    .imageExtent = { .width = width, .height = rows, .depth = 1 }
+                }
+            });
+
+            row += rows;
+        }
+
+        return true;
+    }
+
+    bool StagingRing::flush()
+    {
+        auto& inst = instance();
+        if (!inst.reclaim(false)) return false;
+        if (inst.pending.empty() && inst.pending_images.empty()) return true;
+
+        // batches retire in submission order, so if ours is still in flight it is the oldest one
+        if (std::ranges::find(inst.in_flight, inst.next_batch) != inst.in_flight.end() && !inst.reclaim(true))
+            return false;
+
+        Batch& batch = inst.batches[inst.next_batch];
+
+        VK_CHECK(vkResetCommandBuffer(batch.command_buffer, 0),
+        {
+            LOG_VK_ERROR("Failed to reset staging command buffer");
+            return false;
+        });
+
+        constexpr VkCommandBufferBeginInfo begin_info
+        {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            .pNext = nullptr,
+            .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+            .pInheritanceInfo = nullptr
+        };
+
+        VK_CHECK(vkBeginCommandBuffer(batch.command_buffer, &begin_info),
+        {
+            LOG_VK_ERROR("Failed to begin staging command buffer");
+            return false;
+        });
+
+        // one copy command per destination
+        std::ranges::stable_sort(inst.pending, {}, &PendingCopy::destination);
+        std::ranges::stable_sort(inst.pending_images, {}, &PendingImageCopy::destination);
+
+        inst.record_image_barriers(batch.command_buffer, true);
+
+        std::vector<VkBufferCopy> regions;
+        for (auto it = inst.pending.begin(); it != inst.pending.end();)
+        {
+            const VkBuffer destination = it->destination;
+
+            regions.clear();
+            for (; it != inst.pending.end() && it->destination == destination; ++it)
+                regions.push_back(it->region);
+
+            vkCmdCopyBuffer(batch.command_buffer, inst.ring.get_buffer(), destination,
+                static_cast<uint32_t>(regions.size()), regions.data());
+        }
+
+        std::vector<VkBufferImageCopy> image_regions;
+        for (auto it = inst.pending_images.begin(); it != inst.pending_images.end();)
+        {
+            const VkImage destination = it->destination;
+
+            image_regions.clear();
+            for (; it != inst.pending_images.end() && it->destination == destination; ++it)
+                image_regions.push_back(it->region);
+
+            vkCmdCopyBufferToImage(batch.command_buffer, inst.ring.get_buffer(), destination,
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(image_regions.size()), image_regions.data());
+        }
+
+        inst.record_image_barriers(batch.command_buffer, false);
+
+        VK_CHECK(vkEndCommandBuffer(batch.command_buffer),
+        {
+            LOG_VK_ERROR("Failed to end staging command buffer");
+            return false;
+        });
+
+        // the semaphore signal makes the copies available; consumers wait on it at their first use
+        const VkSemaphoreSubmitInfo signal_semaphore_info
+        {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+            .pNext = nullptr,
+            .semaphore = inst.timeline,
+            .value = inst.submitted_value + 1,
+            .stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+            .deviceIndex = 0
+        };
+
+        const VkCommandBufferSubmitInfo cmd_submit_info
+        {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+            .pNext = nullptr,
+            .commandBuffer = batch.command_buffer,
+            .deviceMask = 0
+        };
+
+        const VkSubmitInfo2 submit_info
+        {
+            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+            .pNext = nullptr,
+            .flags = 0,
+            .waitSemaphoreInfoCount = 0,
+            .pWaitSemaphoreInfos = nullptr,
+            .commandBufferInfoCount = 1,
+            .pCommandBufferInfos = &cmd_submit_info,
+            .signalSemaphoreInfoCount = 1,
+            .pSignalSemaphoreInfos = &signal_semaphore_info
+        };
+
+        VK_CHECK(vkQueueSubmit2(Device::get_transfer_queue(), 1, &submit_info, nullptr),
+        {
+            LOG_VK_ERROR("Failed to submit staging copies");
+            return false;
+        });
+
+        batch.value        = ++inst.submitted_value;
+        batch.bytes        = inst.pending_bytes;
+        inst.pending_bytes = 0;
+        inst.pending.clear();
+        inst.pending_images.clear();
+
+        inst.in_flight.push_back(inst.next_batch);
+        inst.next_batch = (inst.next_batch + 1) % max_batches;
+
+        return true;
+    }
+
+    bool StagingRing::wait_idle()
+    {
+        auto& inst = instance();
+        if (!flush()) return false;
+
+        while (!inst.in_flight.empty())
+        {
+            if (!inst.reclaim(true)) return false;
+        }
+
+        return true;
+    }
+
+
+    VkSemaphore StagingRing::get_timeline_semaphore() { return instance().timeline; }
+    uint64_t    StagingRing::get_submitted_value() { return instance().submitted_value; }
+
+
+    std::optional<VkDeviceSize> StagingRing::allocate(const VkDeviceSize size, const VkDeviceSize align)
+    {
+        // an empty ring starts over, so anything up to its full capacity fits once everything has drained
+        if (used == 0) head = 0;
+
+        VkDeviceSize offset  = (head + align - 1) / align * align;
+        VkDeviceSize padding = offset - head;
+
+        if (offset + size > capacity)
+        {
+            padding = capacity - head;
+            offset  = 0;
+        }
+
+        if (used + padding + size > capacity) return std::nullopt;
+
+        head = offset + size;
+        used += padding + size;
+        pending_bytes += padding + size;
+
+        return offset;
+    }
+
+    std::optional<VkDeviceSize> StagingRing::allocate_or_wait(const VkDeviceSize size, const VkDeviceSize align)
+    {
+        std::optional<VkDeviceSize> offset;
+        while (!((offset = allocate(size, align))))
+        {
+            if (!flush()) return std::nullopt;
+            if (!reclaim(true)) return std::nullopt;
+        }
+
+        return offset;
+    }
+
+    bool StagingRing::reclaim(const bool wait)
+    {
+        if (in_flight.empty()) return true;
+
+        uint64_t completed = 0;
+        VK_CHECK(vkGetSemaphoreCounterValue(Device::get_device(), timeline, &completed),
+        {
+            LOG_VK_ERROR("Failed to query staging timeline semaphore");
+            return false;
+        });
+
+        while (!in_flight.empty())
+        {
+            Batch& batch = batches[in_flight.front()];
+
+            if (completed < batch.value)
+            {
+                if (!wait) break;
+
+                const VkSemaphoreWaitInfo wait_info
+                {
+                    .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+                    .pNext = nullptr,
+                    .flags = 0,
+                    .semaphoreCount = 1,
+                    .pSemaphores = &timeline,
+                    .pValues = &batch.value
+                };
+
+                VK_CHECK(vkWaitSemaphores(Device::get_device(), &wait_info, UINT64_MAX),
+                {
+                    LOG_VK_ERROR("Failed to wait for staging timeline semaphore");
+                    return false;
+                });
+
+                completed = batch.value;
+            }
+
+            used -= batch.bytes;
+            batch.bytes = 0;
+            in_flight.pop_front();
+
+            // one retired batch is enough progress for a blocking caller
+            if (wait) break;
+        }
+
+        return true;
+    }
+
+    void StagingRing::record_image_barriers(const VkCommandBuffer command_buffer, const bool before_copy) const
+    {
+        if (pending_images.empty()) return;
+
+        // pending_images is sorted by image, and each image's chunks keep their upload order
+        std::vector<VkImageMemoryBarrier> barriers;
+        VkPipelineStageFlags              source_stage = before_copy ? VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT : VK_PIPELINE_STAGE_TRANSFER_BIT;
+
+        for (auto it = pending_images.begin(); it != pending_images.end(); ++it)
+        {
+            if (!barriers.empty() && barriers.back().image == it->destination) continue;
+
+            VkImageMemoryBarrier barrier
+            {
+                .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+                .pNext = nullptr,
+                .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                .dstAccessMask = 0,
+                .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                .newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .image = it->destination,
+                .subresourceRange = {
+                    .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                    .baseMipLevel = 0,
+                    .levelCount = 1,
+                    .baseArrayLayer = 0,
+                    .layerCount = 1
+                }
+            };
+
+            if (before_copy)
+            {
+                barrier.srcAccessMask = 0;
+                barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                barrier.oldLayout     = it->old_layout;
+                barrier.newLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+
+                // the rest of an image split across batches must wait for the previous batch's writes
+                if (it->old_layout != VK_IMAGE_LAYOUT_UNDEFINED)
+                {
+                    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                    source_stage          = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+                }
+            }
+
+            barriers.push_back(barrier);
+        }
+
+        // visibility to the graphics queue comes from its timeline semaphore wait
+        vkCmdPipelineBarrier(
+            command_buffer,
+            source_stage,
+            before_copy ? VK_PIPELINE_STAGE_TRANSFER_BIT : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+            0,
+            0, nullptr,
+            0, nullptr,
+            static_cast<uint32_t>(barriers.size()), barriers.data()
+        );
+    }
+}
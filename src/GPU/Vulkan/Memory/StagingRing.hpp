@@ -0,0 +1,83 @@
+#pragma once
+#include "boza_pch.hpp"
+#include "Singleton.hpp"
+#include "Buffer.hpp"
+
+namespace boza
+{
+    // Persistently mapped upload ring for device-local buffers and images. Copies queued between two flushes
+    // go out in a single submission on the transfer queue, which signals a timeline semaphore that the frame
+    // submission waits on; ring space is reused once the semaphore has passed the batch's value.
+    // Like the rest of the renderer, it is driven from the render thread only.
+    class StagingRing final : public Singleton<StagingRing>
+    {
+    public:
+        [[nodiscard]] static bool create(VkDeviceSize capacity = default_capacity);
+        static void destroy();
+
+        // The data is copied into the ring immediately; the GPU copy is recorded by the next flush().
+        [[nodiscard]] static bool upload(VkBuffer destination, const void* data, VkDeviceSize size, VkDeviceSize offset = 0);
+        // Replaces the whole first mip of a single-layer color image, which ends up in SHADER_READ_ONLY_OPTIMAL.
+        [[nodiscard]] static bool upload_image(VkImage destination, const void* data, uint32_t width, uint32_t height, uint32_t texel_size);
+
+        // Submits every queued copy and layout transition; their results are visible to anything
+        // submitted afterwards that waits on get_timeline_semaphore() at get_submitted_value().
+        [[nodiscard]] static bool flush();
+        [[nodiscard]] static bool wait_idle();
+
+        [[nodiscard]] static VkSemaphore get_timeline_semaphore();
+        [[nodiscard]] static uint64_t    get_submitted_value();
+
+    private:
+        static constexpr VkDeviceSize default_capacity = 64ull * 1024 * 1024;
+        static constexpr VkDeviceSize alignment        = 16;
+        static constexpr uint32_t     max_batches      = 4;
+
+        struct Batch
+        {
+            VkCommandBuffer command_buffer{ nullptr };
+            uint64_t        value{ 0 };
+            // ring bytes, including wrap padding, released once the timeline reaches value
+            VkDeviceSize    bytes{ 0 };
+        };
+
+        struct PendingCopy
+        {
+            VkBuffer     destination;
+            VkBufferCopy region;
+        };
+
+        struct PendingImageCopy
+        {
+            VkImage           destination;
+            // UNDEFINED for an image's first chunk, so earlier contents are discarded only once
+            VkImageLayout     old_layout;
+            VkBufferImageCopy region;
+        };
+
+        [[nodiscard]] std::optional<VkDeviceSize> allocate(VkDeviceSize size, VkDeviceSize align = alignment);
+        [[nodiscard]] std::optional<VkDeviceSize> allocate_or_wait(VkDeviceSize size, VkDeviceSize align = alignment);
+        [[nodiscard]] bool                        reclaim(bool wait);
+
+        void record_image_barriers(VkCommandBuffer command_buffer, bool before_copy) const;
+
+        Buffer       ring{};
+        std::byte*   mapped{ nullptr };
+        VkDeviceSize capacity{ 0 };
+        VkDeviceSize head{ 0 };
+        VkDeviceSize used{ 0 };
+        VkDeviceSize pending_bytes{ 0 };
+
+        VkCommandPool                  command_pool{ nullptr };
+        VkSemaphore                    timeline{ nullptr };
+        uint64_t                       submitted_value{ 0 };
+        std::array<Batch, max_batches> batches{};
+        std::deque<uint32_t>           in_flight;
+        uint32_t                       next_batch{ 0 };
+        std::vector<PendingCopy>       pending;
+        std::vector<PendingImageCopy>  pending_images;
+
+        friend Singleton;
+        StagingRing() = default;
+    };
+}
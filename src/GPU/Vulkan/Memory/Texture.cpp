@@ -1,8 +1,8 @@
 #include "Texture.hpp"
 
 #include "Allocator.hpp"
+#include "StagingRing.hpp"
 #include "GPU/Vulkan/Core/Device.hpp"
-#include "GPU/Vulkan/Core/CommandPool.hpp"
 #include "GPU/Vulkan/Descriptor/DescriptorSet.hpp"
 #include "Logger.hpp"
 
@@ -52,47 +52,29 @@ namespace boza
             return {};
         }
 
-        const VkDeviceSize image_size = tex_width * tex_height * 4;
-
-        Buffer staging_buffer = Buffer::create_staging_buffer(image_size);
-        staging_buffer.write(pixels, image_size, 0);
-
-        stbi_image_free(pixels);
-
         Texture texture = create_empty(tex_width, tex_height, VK_FORMAT_R8G8B8A8_UNORM,
             VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT);
 
         if (texture.image == nullptr)
         {
-            staging_buffer.destroy();
-            return {};
-        }
-
-        if (!texture.transition_image_layout(VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL))
-        {
-            staging_buffer.destroy();
-            texture.destroy();
+            stbi_image_free(pixels);
             return {};
         }
 
-        if (!texture.copy_buffer_to_image(staging_buffer.get_buffer()))
-        {
-            staging_buffer.destroy();
-            texture.destroy();
-            return {};
-        }
+        // the copy and both layout transitions go out with the next staging flush
+        const bool uploaded = StagingRing::upload_image(texture.image, pixels, texture.width, texture.height, 4);
+        stbi_image_free(pixels);
 
-        if (!texture.transition_image_layout(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL))
+        if (!uploaded)
         {
-            staging_buffer.destroy();
             texture.destroy();
             return {};
         }
 
-        staging_buffer.destroy();
-
         if (!texture.create_image_view(VK_FORMAT_R8G8B8A8_UNORM) || !texture.create_sampler())
         {
+            // the queued copy still references the image
+            if (!StagingRing::wait_idle()) Logger::error("Failed to wait for pending staging copies");
             texture.destroy();
             return {};
         }
@@ -108,6 +90,10 @@ namespace boza
         texture.height = height;
         texture.format = format;
 
+        const auto& families = Device::get_queue_family_indices();
+        const std::array queue_family_indices{ families.graphics_family, families.transfer_family };
+        const bool concurrent = (usage & VK_IMAGE_USAGE_TRANSFER_DST_BIT) && queue_family_indices[0] != queue_family_indices[1];
+
         const VkImageCreateInfo image_info
         {
             .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
@@ -121,9 +107,9 @@ namespace boza
             .samples = VK_SAMPLE_COUNT_1_BIT,
             .tiling = VK_IMAGE_TILING_OPTIMAL,
             .usage = usage,
-            .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
-            .queueFamilyIndexCount = 0,
-            .pQueueFamilyIndices = nullptr,
+            .sharingMode = concurrent ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE,
+            .queueFamilyIndexCount = concurrent ? 2u : 0u,
+            .pQueueFamilyIndices = queue_family_indices.data(),
             .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED
         };
 
@@ -212,97 +198,6 @@ namespace boza
     }
 
 
-    bool Texture::transition_image_layout(const VkImageLayout old_layout, const VkImageLayout new_layout) const
-    {
-        VkCommandBuffer command_buffer = CommandPool::begin_single_time_commands();
-
-        VkImageMemoryBarrier barrier
-        {
-            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-            .pNext = nullptr,
-            .srcAccessMask = {},
-            .dstAccessMask = {},
-            .oldLayout = old_layout,
-            .newLayout = new_layout,
-            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-            .image = image,
-            .subresourceRange = {
-                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-                .baseMipLevel = 0,
-                .levelCount = 1,
-                .baseArrayLayer = 0,
-                .layerCount = 1
-            }
-        };
-
-        VkPipelineStageFlags source_stage;
-        VkPipelineStageFlags destination_stage;
-
-        if (old_layout == VK_IMAGE_LAYOUT_UNDEFINED && new_layout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
-        {
-            barrier.srcAccessMask = 0;
-            barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-            source_stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-            destination_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-        }
-        else if (old_layout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && new_layout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
-        {
-            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-            source_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-            destination_stage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-        }
-        else
-        {
-            Logger::error("Unsupported layout transition!");
-            return false;
-        }
-
-        vkCmdPipelineBarrier(
-            command_buffer,
-            source_stage, destination_stage,
-            0,
-            0, nullptr,
-            0, nullptr,
-            1, &barrier
-        );
-
-        return CommandPool::end_single_time_commands(command_buffer);
-    }
-
-    bool Texture::copy_buffer_to_image(VkBuffer buffer) const
-    {
-        VkCommandBuffer command_buffer = CommandPool::begin_single_time_commands();
-
-        const VkBufferImageCopy region
-        {
-            .bufferOffset = 0,
-            .bufferRowLength = 0,
-            .bufferImageHeight = 0,
-            .imageSubresource = {
-                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-                .mipLevel = 0,
-                .baseArrayLayer = 0,
-                .layerCount = 1
-            },
-            .imageOffset = { .x = 0, .y = 0, .z = 0 },
-            .imageExtent = { .width = width, .height = height, .depth = 1 }
-        };
-
-        vkCmdCopyBufferToImage(
-            command_buffer,
-            buffer,
-            image,
-            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-            1,
-            &region
-        );
-
-        return CommandPool::end_single_time_commands(command_buffer);
-    }
-
-
     void Texture::destroy()
     {
         if (sampler != nullptr)
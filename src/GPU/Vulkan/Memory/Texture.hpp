@@ -28,10 +28,6 @@ namespace boza
         bool create_image_view(VkFormat format);
         bool create_sampler();
 
-        [[nodiscard]]
-        bool transition_image_layout(VkImageLayout old_layout, VkImageLayout new_layout) const;
-        bool copy_buffer_to_image(VkBuffer buffer) const;
-
         VkImage image{ nullptr };
         VkImageView image_view{ nullptr };
         VkSampler sampler{ nullptr };
@@ -0,0 +1,77 @@
+#include "UniformRing.hpp"
+
+#include "GPU/Vulkan/Core/Device.hpp"
+#include "GPU/Vulkan/Core/Swapchain.hpp"
+#include "Logger.hpp"
+
+namespace boza
+{
+    bool UniformRing::create(const VkDeviceSize frame_capacity)
+    {
+        auto& inst = instance();
+
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(Device::get_physical_device(), &properties);
+
+        inst.alignment      = std::max<VkDeviceSize>(properties.limits.minUniformBufferOffsetAlignment, 1);
+        inst.frame_capacity = (frame_capacity + inst.alignment - 1) / inst.alignment * inst.alignment;
+
+        inst.buffer = Buffer::create_uniform_buffer(inst.frame_capacity * Swapchain::max_frames_in_flight);
+        if (inst.buffer.get_buffer() == nullptr)
+        {
+            Logger::critical("Failed to create uniform ring buffer");
+            return false;
+        }
+
+        inst.mapped     = static_cast<std::byte*>(inst.buffer.get_mapped_data());
+        inst.frame_base = 0;
+        inst.head       = 0;
+        return true;
+    }
+
+    void UniformRing::destroy()
+    {
+        auto& inst = instance();
+
+        inst.buffer.destroy();
+        inst.mapped     = nullptr;
+        inst.frame_base = 0;
+        inst.head       = 0;
+    }
+
+
+    void UniformRing::begin_frame()
+    {
+        auto& inst = instance();
+
+        inst.frame_base = Swapchain::current_frame_idx() * inst.frame_capacity;
+        inst.head       = 0;
+    }
+
+    std::optional<UniformRing::Allocation> UniformRing::allocate(const VkDeviceSize size)
+    {
+        auto& inst = instance();
+
+        if (inst.head + size > inst.frame_capacity)
+        {
+            Logger::error("Uniform ring is out of space for this frame ({} bytes per frame)", inst.frame_capacity);
+            return std::nullopt;
+        }
+
+        const VkDeviceSize offset = inst.frame_base + inst.head;
+        inst.head += (size + inst.alignment - 1) / inst.alignment * inst.alignment;
+
+        return Allocation{ inst.mapped + offset, static_cast<uint32_t>(offset) };
+    }
+
+    std::optional<uint32_t> UniformRing::write(const void* data, const VkDeviceSize size)
+    {
+        const auto allocation = allocate(size);
+        if (!allocation) return std::nullopt;
+
+        memcpy(allocation->data, data, size);
+        return allocation->offset;
+    }
+
+    VkBuffer UniformRing::get_buffer() { return instance().buffer.get_buffer(); }
+}
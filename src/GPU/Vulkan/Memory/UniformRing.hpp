@@ -0,0 +1,45 @@
+#pragma once
+#include "boza_pch.hpp"
+#include "Singleton.hpp"
+#include "Buffer.hpp"
+
+namespace boza
+{
+    // One persistently mapped uniform buffer split into a region per frame in flight. Each frame bump-allocates
+    // from its region and rewinds it once the frame's fence has signalled, so uniform data is only valid
+    // for the frame it was written in and must be rewritten every frame it is used.
+    class UniformRing final : public Singleton<UniformRing>
+    {
+    public:
+        struct Allocation
+        {
+            void*    data;
+            // absolute within get_buffer(), meant to be passed as a dynamic offset
+            uint32_t offset;
+        };
+
+        [[nodiscard]] static bool create(VkDeviceSize frame_capacity = default_frame_capacity);
+        static void destroy();
+
+        // Rewinds the current frame's region; call after Swapchain::acquire_next_image has waited on its fence.
+        static void begin_frame();
+
+        [[nodiscard]] static std::optional<Allocation> allocate(VkDeviceSize size);
+        [[nodiscard]] static std::optional<uint32_t>   write(const void* data, VkDeviceSize size);
+
+        [[nodiscard]] static VkBuffer get_buffer();
+
+    private:
+        static constexpr VkDeviceSize default_frame_capacity = 4ull * 1024 * 1024;
+
+        Buffer       buffer{};
+        std::byte*   mapped{ nullptr };
+        VkDeviceSize frame_capacity{ 0 };
+        VkDeviceSize alignment{ 0 };
+        VkDeviceSize frame_base{ 0 };
+        VkDeviceSize head{ 0 };
+
+        friend Singleton;
+        UniformRing() = default;
+    };
+}
@@ -6,9 +6,13 @@
 
 namespace boza
 {
-    Pipeline::Pipeline(const PipelineCreateInfo& create_info)
+    Pipeline::Pipeline(const PipelineCreateInfo& create_info) : layout{ create_info.layout }
     {
-        if (!create_pipeline(create_info)) Logger::critical("failed to create pipeline");
+        const bool created = create_info.compute_shader != nullptr ? create_compute_pipeline(create_info)
+                           : !create_info.libraries.empty()        ? link_pipeline(create_info)
+                                                                   : create_pipeline(create_info);
+
+        if (!created) Logger::critical("failed to create pipeline");
     }
 
     Pipeline::~Pipeline()
@@ -18,13 +22,13 @@ namespace boza
         if (device == nullptr) return;
 
         if (pipeline != nullptr) vkDestroyPipeline(device, pipeline, nullptr);
-        if (layout != nullptr) vkDestroyPipelineLayout(device, layout, nullptr);
     }
 
     Pipeline::Pipeline(Pipeline&& other) noexcept
     {
         pipeline = std::exchange(other.pipeline, nullptr);
         layout = std::exchange(other.layout, nullptr);
+        bind_point = other.bind_point;
     }
 
     Pipeline& Pipeline::operator=(Pipeline&& other) noexcept
@@ -33,6 +37,7 @@ namespace boza
         {
             pipeline = std::exchange(other.pipeline, nullptr);
             layout = std::exchange(other.layout, nullptr);
+            bind_point = other.bind_point;
         }
 
         return *this;
@@ -41,6 +46,7 @@ namespace boza
 
     VkPipeline&       Pipeline::get_pipeline() { return pipeline; }
     VkPipelineLayout& Pipeline::get_layout() { return layout; }
+    VkPipelineBindPoint Pipeline::get_bind_point() const { return bind_point; }
 
 
     bool Pipeline::create_pipeline(const PipelineCreateInfo& create_info)
@@ -72,8 +78,8 @@ namespace boza
             VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
             nullptr,
             {},
-            create_info.binding.stride == 0 ? 0u : 1u,
-            create_info.binding.stride == 0 ? nullptr : &create_info.binding,
+            static_cast<uint32_t>(create_info.bindings.size()),
+            create_info.bindings.data(),
             static_cast<uint32_t>(create_info.attributes.size()),
             create_info.attributes.data(),
         };
@@ -172,8 +178,6 @@ namespace boza
             .blendConstants = { 0.0f, 0.0f, 0.0f, 0.0f }
         };
 
-        if (!create_pipeline_layout(create_info)) return false;
-
         VkPipelineRenderingCreateInfoKHR pipeline_rendering_create_info
         {
             .sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR,
@@ -195,30 +199,53 @@ namespace boza
             .pDynamicStates = dynamic_states
         };
 
+        // a library part only takes the state of its own subset; a complete pipeline has every subset
+        const auto has = [&create_info](const VkGraphicsPipelineLibraryFlagBitsEXT part)
+        {
+            return create_info.library_parts == 0 || (create_info.library_parts & part) != 0;
+        };
+
+        const bool vertex_input   = has(VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT);
+        const bool pre_raster     = has(VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT);
+        const bool fragment       = has(VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT);
+        const bool fragment_out   = has(VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT);
+        const auto stage_count    = static_cast<uint32_t>(pre_raster) + static_cast<uint32_t>(fragment);
+
+        const VkGraphicsPipelineLibraryCreateInfoEXT library_info
+        {
+            .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT,
+            .pNext = &pipeline_rendering_create_info,
+            .flags = create_info.library_parts
+        };
+
         VkGraphicsPipelineCreateInfo pipeline_info
         {
             .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
-            .pNext = &pipeline_rendering_create_info,
-            .flags = {},
-            .stageCount = std::size(shader_stages),
-            .pStages = shader_stages,
-            .pVertexInputState = &vertex_input_info,
-            .pInputAssemblyState = &input_assembly_info,
+            .pNext = create_info.library_parts != 0
+                ? static_cast<const void*>(&library_info)
+                : static_cast<const void*>(&pipeline_rendering_create_info),
+            .flags = create_info.library_parts != 0
+                ? VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT
+                : VkPipelineCreateFlags{},
+            .stageCount = stage_count,
+            .pStages = stage_count != 0 ? shader_stages + (pre_raster ? 0 : 1) : nullptr,
+            .pVertexInputState = vertex_input ? &vertex_input_info : nullptr,
+            .pInputAssemblyState = vertex_input ? &input_assembly_info : nullptr,
             .pTessellationState = nullptr,
-            .pViewportState = &viewport_info,
-            .pRasterizationState = &rasterization_info,
-            .pMultisampleState = &multisample_info,
+            .pViewportState = pre_raster ? &viewport_info : nullptr,
+            .pRasterizationState = pre_raster ? &rasterization_info : nullptr,
+            .pMultisampleState = fragment || fragment_out ? &multisample_info : nullptr,
             .pDepthStencilState = nullptr,
-            .pColorBlendState = &color_blend_info,
-            .pDynamicState = &dynamic_state_info,
-            .layout = layout,
+            .pColorBlendState = fragment_out ? &color_blend_info : nullptr,
+            .pDynamicState = pre_raster ? &dynamic_state_info : nullptr,
+            .layout = pre_raster || fragment ? layout : nullptr,
             .renderPass = nullptr,
             .subpass = {},
             .basePipelineHandle = nullptr,
             .basePipelineIndex = 0
         };
 
-        VK_CHECK(vkCreateGraphicsPipelines(Device::get_device(), nullptr, 1, &pipeline_info, nullptr, &pipeline),
+        VK_CHECK(vkCreateGraphicsPipelines(Device::get_device(), create_info.pipeline_cache, 1, &pipeline_info, nullptr, &pipeline),
         {
             LOG_VK_ERROR("Failed to create graphics pipeline");
             return false;
@@ -227,22 +254,60 @@ namespace boza
         return true;
     }
 
-    bool Pipeline::create_pipeline_layout(const PipelineCreateInfo& create_info)
+    bool Pipeline::link_pipeline(const PipelineCreateInfo& create_info)
     {
-         const VkPipelineLayoutCreateInfo layout_info
+        const VkPipelineLibraryCreateInfoKHR library_info
         {
-            .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR,
+            .pNext = nullptr,
+            .libraryCount = static_cast<uint32_t>(create_info.libraries.size()),
+            .pLibraries = create_info.libraries.data()
+        };
+
+        // without link time optimisation this is a cheap link of the precompiled parts
+        const VkGraphicsPipelineCreateInfo pipeline_info
+        {
+            .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+            .pNext = &library_info,
+            .flags = create_info.optimise_link ? VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT : VkPipelineCreateFlags{},
+            .layout = layout
+        };
+
+        VK_CHECK(vkCreateGraphicsPipelines(Device::get_device(), create_info.pipeline_cache, 1, &pipeline_info, nullptr, &pipeline),
+        {
+            LOG_VK_ERROR("Failed to link graphics pipeline");
+            return false;
+        });
+
+        return true;
+    }
+
+    bool Pipeline::create_compute_pipeline(const PipelineCreateInfo& create_info)
+    {
+        bind_point = VK_PIPELINE_BIND_POINT_COMPUTE;
+
+        const VkComputePipelineCreateInfo pipeline_info
+        {
+            .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
             .pNext = nullptr,
             .flags = {},
-            .setLayoutCount = static_cast<uint32_t>(create_info.descriptor_set_layouts.size()),
-            .pSetLayouts = create_info.descriptor_set_layouts.data(),
-            .pushConstantRangeCount = static_cast<uint32_t>(create_info.push_constant_ranges.size()),
-            .pPushConstantRanges = create_info.push_constant_ranges.data(),
+            .stage = {
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                .pNext = nullptr,
+                .flags = {},
+                .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+                .module = create_info.compute_shader,
+                .pName = "main",
+                .pSpecializationInfo = nullptr
+            },
+            .layout = layout,
+            .basePipelineHandle = nullptr,
+            .basePipelineIndex = 0
         };
 
-        VK_CHECK(vkCreatePipelineLayout(Device::get_device(), &layout_info, nullptr, &layout),
+        VK_CHECK(vkCreateComputePipelines(Device::get_device(), create_info.pipeline_cache, 1, &pipeline_info, nullptr, &pipeline),
         {
-            LOG_VK_ERROR("Failed to create pipeline layout");
+            LOG_VK_ERROR("Failed to create compute pipeline");
             return false;
         });
 
@@ -5,17 +5,26 @@ namespace boza
 {
     struct PipelineCreateInfo
     {
-        VkVertexInputBindingDescription binding{};
+        std::vector<VkVertexInputBindingDescription>   bindings;
         std::vector<VkVertexInputAttributeDescription> attributes;
 
-        std::vector<VkDescriptorSetLayout> descriptor_set_layouts;
-        std::vector<VkPushConstantRange>   push_constant_ranges;
-
+        // borrowed; PipelineManager shares layouts between pipelines and owns them
+        VkPipelineLayout layout{ nullptr };
 
         VkShaderModule vertex_shader{ nullptr };
         VkShaderModule fragment_shader{ nullptr };
+        // set instead of the graphics stages for a compute pipeline
+        VkShaderModule compute_shader{ nullptr };
 
         VkPolygonMode polygon_mode{ VK_POLYGON_MODE_FILL };
+
+        VkPipelineCache pipeline_cache{ nullptr };
+
+        // non-zero compiles only these graphics pipeline library parts; fields of the other parts are ignored
+        VkGraphicsPipelineLibraryFlagsEXT library_parts{ 0 };
+        // when set, the pipeline is linked from these parts instead of compiled from the fields above
+        std::vector<VkPipeline> libraries;
+        bool                    optimise_link{ false };
     };
 
     class Pipeline final
@@ -29,15 +38,18 @@ namespace boza
 
         VkPipeline& get_pipeline();
         VkPipelineLayout& get_layout();
+        [[nodiscard]] VkPipelineBindPoint get_bind_point() const;
 
     private:
         friend class PipelineManager;
 
         explicit Pipeline(const PipelineCreateInfo& create_info);
         bool create_pipeline(const PipelineCreateInfo& create_info);
-        bool create_pipeline_layout(const PipelineCreateInfo& create_info);
+        bool create_compute_pipeline(const PipelineCreateInfo& create_info);
+        bool link_pipeline(const PipelineCreateInfo& create_info);
 
         VkPipeline pipeline{ nullptr };
         VkPipelineLayout layout{ nullptr };
+        VkPipelineBindPoint bind_point{ VK_PIPELINE_BIND_POINT_GRAPHICS };
     };
 }
@@ -0,0 +1,177 @@
+#include "PipelineCache.hpp"
+
+#include "GPU/Vulkan/Core/Device.hpp"
+#include "Logger.hpp"
+#include "Profiler.hpp"
+
+namespace boza
+{
+    bool PipelineCache::load(const fs::path& path)
+    {
+        BOZA_PROFILE_FUNCTION();
+
+        this->path = path;
+
+        std::vector<std::byte> contents;
+        if (std::ifstream file{ path, std::ios::binary | std::ios::ate }; file.is_open())
+        {
+            contents.resize(static_cast<size_t>(file.tellg()));
+            file.seekg(0);
+            file.read(reinterpret_cast<char*>(contents.data()), static_cast<std::streamsize>(contents.size()));
+            if (!file) contents.clear();
+        }
+
+        std::span<const std::byte> initial_data;
+        if (contents.size() >= sizeof(FileHeader))
+        {
+            FileHeader header;
+            memcpy(&header, contents.data(), sizeof(FileHeader));
+
+            const FileHeader expected = make_header();
+            const auto       payload  = std::span{ contents }.subspan(sizeof(FileHeader));
+
+            if (header.magic != expected.magic || header.version != expected.version)
+                Logger::warn("Ignoring pipeline cache '{}': not a pipeline cache file", path.string());
+            else if (header.vendor_id != expected.vendor_id || header.device_id != expected.device_id ||
+                     header.driver_version != expected.driver_version ||
+                     memcmp(header.cache_uuid, expected.cache_uuid, VK_UUID_SIZE) != 0)
+                Logger::info("Ignoring pipeline cache '{}': written by another device or driver", path.string());
+            else if (header.data_size != payload.size() || header.data_hash != hash(payload))
+                Logger::warn("Ignoring pipeline cache '{}': truncated or corrupted", path.string());
+            else
+                initial_data = payload;
+        }
+
+        VkPipelineCacheCreateInfo create_info
+        {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = {},
+            .initialDataSize = initial_data.size(),
+            .pInitialData = initial_data.data()
+        };
+
+        // the driver may still reject data it wrote itself; an empty cache is always acceptable
+        if (vkCreatePipelineCache(Device::get_device(), &create_info, nullptr, &cache) == VK_SUCCESS)
+        {
+            if (!initial_data.empty()) Logger::debug("Loaded pipeline cache '{}' ({} bytes)", path.string(), initial_data.size());
+            return true;
+        }
+
+        create_info.initialDataSize = 0;
+        create_info.pInitialData    = nullptr;
+
+        VK_CHECK(vkCreatePipelineCache(Device::get_device(), &create_info, nullptr, &cache),
+        {
+            LOG_VK_ERROR("Failed to create pipeline cache");
+            return false;
+        });
+
+        return true;
+    }
+
+    void PipelineCache::destroy()
+    {
+        if (cache != nullptr) vkDestroyPipelineCache(Device::get_device(), cache, nullptr);
+        cache = nullptr;
+    }
+
+
+    bool PipelineCache::save() const
+    {
+        BOZA_PROFILE_FUNCTION();
+
+        if (cache == nullptr || path.empty()) return false;
+
+        // other threads may keep adding pipelines, so the size can grow between the two calls
+        std::vector<std::byte> data;
+        VkResult               result;
+        do
+        {
+            size_t size = 0;
+            VK_CHECK(vkGetPipelineCacheData(Device::get_device(), cache, &size, nullptr),
+            {
+                LOG_VK_ERROR("Failed to query pipeline cache size");
+                return false;
+            });
+
+            data.resize(sizeof(FileHeader) + size);
+            result = vkGetPipelineCacheData(Device::get_device(), cache, &size, data.data() + sizeof(FileHeader));
+            data.resize(sizeof(FileHeader) + size);
+        } while (result == VK_INCOMPLETE);
+
+        if (result != VK_SUCCESS)
+        {
+            LOG_VK_ERROR("Failed to read pipeline cache data");
+            return false;
+        }
+
+        FileHeader header = make_header();
+        header.data_size  = data.size() - sizeof(FileHeader);
+        header.data_hash  = hash(std::span{ data }.subspan(sizeof(FileHeader)));
+        memcpy(data.data(), &header, sizeof(FileHeader));
+
+        std::error_code error;
+        if (path.has_parent_path()) fs::create_directories(path.parent_path(), error);
+
+        fs::path temporary = path;
+        temporary += ".tmp";
+
+        {
+            std::ofstream file{ temporary, std::ios::binary | std::ios::trunc };
+            file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+            if (!file)
+            {
+                Logger::error("Failed to write pipeline cache '{}'", temporary.string());
+                return false;
+            }
+        }
+
+        fs::rename(temporary, path, error);
+        if (error)
+        {
+            Logger::error("Failed to replace pipeline cache '{}': {}", path.string(), error.message());
+            fs::remove(temporary, error);
+            return false;
+        }
+
+        return true;
+    }
+
+    VkPipelineCache PipelineCache::get_cache() const { return cache; }
+
+
+    PipelineCache::FileHeader PipelineCache::make_header()
+    {
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(Device::get_physical_device(), &properties);
+
+        FileHeader header
+        {
+            .magic = file_magic,
+            .version = file_version,
+            .vendor_id = properties.vendorID,
+            .device_id = properties.deviceID,
+            .driver_version = properties.driverVersion,
+            .cache_uuid = {},
+            .data_size = 0,
+            .data_hash = 0
+        };
+
+        memcpy(header.cache_uuid, properties.pipelineCacheUUID, VK_UUID_SIZE);
+        return header;
+    }
+
+    uint64_t PipelineCache::hash(const std::span<const std::byte> data)
+    {
+        // FNV-1a, only meant to catch torn or truncated files
+        uint64_t value = 0xcbf2'9ce4'8422'2325ull;
+        for (const std::byte byte : data)
+        {
+            value ^= static_cast<uint64_t>(byte);
+            value *= 0x0000'0100'0000'01b3ull;
+        }
+
+        return value;
+    }
+}
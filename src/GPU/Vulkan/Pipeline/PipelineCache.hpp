@@ -0,0 +1,44 @@
+#pragma once
+#include "boza_pch.hpp"
+
+namespace boza
+{
+    // VkPipelineCache persisted to disk. The file carries its own header with the device's pipeline cache UUID,
+    // vendor, device and driver version plus a hash of the payload, so a cache written by another GPU, another
+    // driver or a torn write is dropped instead of being handed to the driver.
+    class PipelineCache final
+    {
+    public:
+        // Starts from an empty cache whenever the file is missing or does not validate.
+        [[nodiscard]] bool load(const fs::path& path);
+        void destroy();
+
+        // Writes a sibling temporary file and renames it over the cache file, so readers never see a partial cache.
+        // Safe to call from any thread; concurrent saves of the same cache are not.
+        [[nodiscard]] bool save() const;
+
+        [[nodiscard]] VkPipelineCache get_cache() const;
+
+    private:
+        struct FileHeader
+        {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t vendor_id;
+            uint32_t device_id;
+            uint32_t driver_version;
+            uint8_t  cache_uuid[VK_UUID_SIZE];
+            uint64_t data_size;
+            uint64_t data_hash;
+        };
+
+        static constexpr uint32_t file_magic   = 0x4350'5A42; // "BZPC"
+        static constexpr uint32_t file_version = 1;
+
+        [[nodiscard]] static FileHeader make_header();
+        [[nodiscard]] static uint64_t   hash(std::span<const std::byte> data);
+
+        VkPipelineCache cache{ nullptr };
+        fs::path        path;
+    };
+}
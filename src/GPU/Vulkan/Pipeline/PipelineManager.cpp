@@ -1,13 +1,14 @@
 #include "PipelineManager.hpp"
 
 #include "Logger.hpp"
+#include "Profiler.hpp"
 #include "GPU/Vulkan/Core/CommandPool.hpp"
 #include "GPU/Vulkan/Core/Device.hpp"
+#include "GPU/Vulkan/Core/Swapchain.hpp"
 #include "ShaderLoader.hpp"
 
-static std::vector<VkDescriptorSetLayout> build_set_layouts(
-    const boza::ShaderReflectionInfo& vert,
-    const boza::ShaderReflectionInfo& frag)
+static std::map<uint32_t, std::vector<VkDescriptorSetLayoutBinding>> merge_set_bindings(
+    const std::initializer_list<const boza::ShaderReflectionInfo*> stages)
 {
     using boza::ShaderReflectionInfo, boza::DescriptorBindingInfo;
 
@@ -62,8 +63,8 @@ static std::vector<VkDescriptorSetLayout> build_set_layouts(
         }
     };
 
-    merge(vert);
-    merge(frag);
+    for (const ShaderReflectionInfo* stage : stages)
+        merge(*stage);
 
     std::map<uint32_t, std::vector<VkDescriptorSetLayoutBinding>> per_set;
     for (auto&& [key, binding] : merged)
@@ -72,39 +73,12 @@ static std::vector<VkDescriptorSetLayout> build_set_layouts(
     for (auto& bindings : per_set | std::views::values)
         std::ranges::sort(bindings, {}, &VkDescriptorSetLayoutBinding::binding);
 
-    std::vector<VkDescriptorSetLayout> layouts;
-    if (!per_set.empty())
-        layouts.resize(per_set.rbegin()->first + 1, VK_NULL_HANDLE);
-
-    for (const auto& [set_index, bindings] : per_set)
-    {
-        VkDescriptorSetLayoutCreateInfo info
-        {
-            .sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
-            .pNext        = nullptr,
-            .flags        = 0,
-            .bindingCount = static_cast<uint32_t>(bindings.size()),
-            .pBindings    = bindings.data()
-        };
-
-        VkDescriptorSetLayout layout = VK_NULL_HANDLE;
-        if (vkCreateDescriptorSetLayout(boza::Device::get_device(),
-                                        &info, nullptr, &layout) != VK_SUCCESS)
-        {
-            boza::Logger::error("Failed to create descriptor set layout (set {})", set_index);
-            continue;
-        }
-
-        layouts[set_index] = layout;
-    }
-
-    return layouts;
+    return per_set;
 }
 
 
 static std::vector<VkPushConstantRange> merge_push_constants(
-    const boza::ShaderReflectionInfo& first,
-    const boza::ShaderReflectionInfo& second)
+    const std::initializer_list<const boza::ShaderReflectionInfo*> stages)
 {
     std::vector<VkPushConstantRange> ranges;
 
@@ -121,74 +95,437 @@ static std::vector<VkPushConstantRange> merge_push_constants(
             ranges.push_back(rng);
     };
 
-    for (const VkPushConstantRange& r : first.push_constants)
-        append_unique(r);
-
-    for (const VkPushConstantRange& r : second.push_constants)
-        append_unique(r);
+    for (const boza::ShaderReflectionInfo* stage : stages)
+        for (const VkPushConstantRange& r : stage->push_constants)
+            append_unique(r);
 
     return ranges;
 }
 
 
+// Cache keys are the raw bytes of everything that affects the created object, so equal keys mean equal objects.
+template<typename... T> requires (std::is_trivially_copyable_v<T> && ...)
+static void append_key(std::string& key, const T&... values)
+{
+    (key.append(reinterpret_cast<const char*>(&values), sizeof(T)), ...);
+}
+
+
 namespace boza
 {
     void PipelineManager::cleanup()
     {
         auto& inst = instance();
-        for (const auto& shader_module : inst.shader_modules | std::views::values)
-            vkDestroyShaderModule(Device::get_device(), shader_module, nullptr);
 
+        for (const auto task : inst.prewarm_tasks)
+            (void)JobSystem::wait_for_task(task);
+        inst.prewarm_tasks.clear();
+
+        for (const auto& pending : inst.pending | std::views::values)
+            (void)JobSystem::wait_for_task(pending.task);
+        for (const auto& optimisation : inst.optimising)
+            (void)JobSystem::wait_for_task(optimisation.task);
+
+        inst.pending.clear();
+        inst.optimising.clear();
+        inst.retired.clear();
+        inst.aliases.clear();
         inst.pipelines.clear();
+        inst.pipeline_ids.clear();
+        inst.library_parts.clear();
+
+        for (const auto& layout : inst.pipeline_layouts | std::views::values)
+            vkDestroyPipelineLayout(Device::get_device(), layout, nullptr);
+        for (const auto& layout : inst.set_layouts | std::views::values)
+            vkDestroyDescriptorSetLayout(Device::get_device(), layout, nullptr);
+        for (const auto& shader : inst.shaders | std::views::values)
+            ShaderLoader::destroy_shader_module(shader.module);
+
+        inst.pipeline_layouts.clear();
+        inst.set_layouts.clear();
+        inst.shaders.clear();
+
+        if (!save_pipeline_cache()) Logger::warn("Pipeline cache was not written back");
+        inst.pipeline_cache.destroy();
+    }
+
+
+    bool PipelineManager::load_pipeline_cache(const fs::path& path)
+    {
+        auto& inst = instance();
+
+        inst.last_save = clock::now();
+        return inst.pipeline_cache.load(path);
+    }
+
+    bool PipelineManager::save_pipeline_cache()
+    {
+        auto& inst = instance();
+
+        if (inst.save_task != JobSystem::INVALID_TASK_ID)
+        {
+            (void)JobSystem::wait_for_task(inst.save_task);
+            inst.save_task = JobSystem::INVALID_TASK_ID;
+            inst.saving.store(false, std::memory_order_relaxed);
+        }
+
+        if (inst.pipeline_cache.get_cache() == nullptr) return true;
+
+        inst.last_save = clock::now();
+        inst.unsaved_pipelines.store(0, std::memory_order_relaxed);
+        return inst.pipeline_cache.save();
+    }
+
+    void PipelineManager::autosave_pipeline_cache()
+    {
+        auto& inst = instance();
+
+        if (inst.pipeline_cache.get_cache() == nullptr || inst.unsaved_pipelines.load(std::memory_order_relaxed) == 0) return;
+        if (clock::now() - inst.last_save < autosave_interval) return;
+
+        if (inst.saving.exchange(true, std::memory_order_acquire)) return;
+
+        inst.last_save = clock::now();
+        inst.unsaved_pipelines.store(0, std::memory_order_relaxed);
+
+        // the cache is internally synchronised, so pipelines can keep being created while it is read
+        inst.save_task = JobSystem::push_task([&inst]
+        {
+            if (!inst.pipeline_cache.save()) Logger::warn("Pipeline cache autosave failed");
+            inst.saving.store(false, std::memory_order_release);
+        }, { .priority = JobPriority::Background });
+
+        // try again at the next interval
+        if (inst.save_task == JobSystem::INVALID_TASK_ID)
+        {
+            inst.unsaved_pipelines.fetch_add(1, std::memory_order_relaxed);
+            inst.saving.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    bool PipelineManager::prewarm(const fs::path& manifest)
+    {
+        BOZA_PROFILE_FUNCTION();
+
+        auto& inst = instance();
+
+        std::ifstream file{ manifest };
+        if (!file.is_open())
+        {
+            Logger::warn("Shader manifest '{}' not found", manifest.string());
+            return false;
+        }
+
+        const json root = json::parse(file, nullptr, false);
+        if (root.is_discarded())
+        {
+            Logger::error("Shader manifest '{}' is not valid JSON", manifest.string());
+            return false;
+        }
+
+        std::vector<ShaderVariant> variants;
+        try
+        {
+            for (const auto& shader : root.at("shaders"))
+            {
+                const auto path = shader.at("path").get<std::string>();
+                for (const auto& keywords : shader.at("variants"))
+                {
+                    const auto mask = ShaderLoader::make_keyword_mask(path, keywords.get<std::vector<std::string>>());
+                    if (!mask.has_value()) return false;
+                    variants.emplace_back(path, *mask);
+                }
+            }
+        }
+        catch (const json::exception& e)
+        {
+            Logger::error("Shader manifest '{}' is malformed: {}", manifest.string(), e.what());
+            return false;
+        }
+
+        Logger::debug("Prewarming {} shader variants from '{}'", variants.size(), manifest.string());
+
+        for (auto& variant : variants)
+        {
+            inst.prewarm_tasks.push_back(JobSystem::push_task([variant = std::move(variant)]
+            {
+                if (!acquire_shader(variant).has_value())
+                    Logger::warn("Failed to prewarm '{}' with keywords {:#x}", variant.path, variant.keywords);
+            }, { .priority = JobPriority::Background }));
+        }
+
+        return true;
     }
 
     pipeline_id_t PipelineManager::create_pipeline(
-        const std::string& vertex_shader,
-        const std::string& fragment_shader,
-        VkPolygonMode polygon_mode)
+        const ShaderVariant& vertex_shader,
+        const ShaderVariant& fragment_shader,
+        const VkPolygonMode  polygon_mode)
+    {
+        return build_pipeline(vertex_shader, fragment_shader, nullptr, polygon_mode);
+    }
+
+    pipeline_id_t PipelineManager::create_pipeline(
+        const ShaderVariant& vertex_shader,
+        const ShaderVariant& fragment_shader,
+        const VertexLayout&  layout,
+        const VkPolygonMode  polygon_mode)
+    {
+        return build_pipeline(vertex_shader, fragment_shader, &layout, polygon_mode);
+    }
+
+    pipeline_id_t PipelineManager::create_pipeline_async(
+        const ShaderVariant& vertex_shader,
+        const ShaderVariant& fragment_shader,
+        const VkPolygonMode  polygon_mode,
+        const pipeline_id_t  fallback)
+    {
+        return build_pipeline_async(vertex_shader, fragment_shader, std::nullopt, polygon_mode, fallback);
+    }
+
+    pipeline_id_t PipelineManager::create_pipeline_async(
+        const ShaderVariant& vertex_shader,
+        const ShaderVariant& fragment_shader,
+        const VertexLayout&  layout,
+        const VkPolygonMode  polygon_mode,
+        const pipeline_id_t  fallback)
+    {
+        return build_pipeline_async(vertex_shader, fragment_shader, layout, polygon_mode, fallback);
+    }
+
+    pipeline_id_t PipelineManager::build_pipeline(
+        const ShaderVariant& vertex_shader,
+        const ShaderVariant& fragment_shader,
+        const VertexLayout*  layout,
+        const VkPolygonMode  polygon_mode)
+    {
+        Logger::debug("Creating pipeline: {} -> {}", vertex_shader.path, fragment_shader.path);
+        const auto create_info = prepare_pipeline(vertex_shader, fragment_shader, layout, polygon_mode);
+        if (!create_info.has_value()) return INVALID_PIPELINE_ID;
+
+        return instantiate(*create_info);
+    }
+
+    pipeline_id_t PipelineManager::build_pipeline_async(
+        const ShaderVariant&               vertex_shader,
+        const ShaderVariant&               fragment_shader,
+        const std::optional<VertexLayout>& layout,
+        const VkPolygonMode                polygon_mode,
+        pipeline_id_t                      fallback)
     {
         auto& inst = instance();
 
-        Logger::debug("Creating pipeline: {} -> {}", vertex_shader, fragment_shader);
-        const auto vert_refl = ShaderLoader::load_shader(vertex_shader);
-        const auto frag_refl = ShaderLoader::load_shader(fragment_shader);
+        Logger::debug("Queueing pipeline: {} -> {}", vertex_shader.path, fragment_shader.path);
 
-        if (!vert_refl || !frag_refl)
+        auto build = std::make_shared<AsyncBuild>();
+
+        std::scoped_lock lock{ inst.mutex };
+        const pipeline_id_t id = inst.next_id++;
+
+        if (fallback != INVALID_PIPELINE_ID && !retain_handle(fallback))
         {
-            Logger::error("Pipeline creation failed: shader loading / reflection error");
+            Logger::warn("Fallback pipeline {} does not exist; pipeline {} has none", fallback, id);
+            fallback = INVALID_PIPELINE_ID;
+        }
+
+        const JobSystem::task_id task = JobSystem::push_task(
+            [build, vertex_shader, fragment_shader, layout, polygon_mode]
+            {
+                auto& inst = instance();
+
+                auto create_info = prepare_pipeline(vertex_shader, fragment_shader, layout ? &*layout : nullptr, polygon_mode);
+                if (create_info.has_value())
+                {
+                    build->key = make_pipeline_key(*create_info);
+                    {
+                        std::scoped_lock lock{ inst.mutex };
+                        build->existing = retain_existing(build->key);
+                    }
+
+                    // already off the render thread, so straight to the optimised link
+                    if (build->existing == INVALID_PIPELINE_ID)
+                        build->pipeline = compile(*create_info, true);
+                }
+
+                build->done.store(true, std::memory_order_release);
+            }, { .priority = JobPriority::Background });
+
+        if (task == JobSystem::INVALID_TASK_ID)
+        {
+            // nothing would ever publish the build, so do not hand out an id that waits for it
+            Logger::error("Failed to queue pipeline {}: job table is full", id);
+            if (fallback != INVALID_PIPELINE_ID) release_handle(fallback);
             return INVALID_PIPELINE_ID;
         }
 
-        const auto set_layouts = build_set_layouts(*vert_refl, *frag_refl);
-        const auto push_constants = merge_push_constants(*vert_refl, *frag_refl);
-        Logger::debug("Built set layouts and merged push constants");
+        inst.pending.emplace(id, PendingPipeline{ .build = std::move(build), .task = task, .fallback = fallback });
+        return id;
+    }
+
+    std::optional<PipelineCreateInfo> PipelineManager::prepare_pipeline(
+        const ShaderVariant& vertex_shader,
+        const ShaderVariant& fragment_shader,
+        const VertexLayout*  layout,
+        const VkPolygonMode  polygon_mode)
+    {
+        const auto vert_refl = acquire_shader(vertex_shader);
+        const auto frag_refl = acquire_shader(fragment_shader);
 
-        PipelineCreateInfo create_info
+        if (!vert_refl || !frag_refl)
         {
-            .binding = vert_refl->binding,
-            .attributes = vert_refl->attributes,
-            .descriptor_set_layouts = std::move(set_layouts),
-            .push_constant_ranges = std::move(push_constants),
+            Logger::error("Pipeline creation failed: shader loading / reflection error");
+            return std::nullopt;
+        }
+
+        if (layout != nullptr)
+        {
+            for (const auto& input : vert_refl->attributes)
+            {
+                if (std::ranges::none_of(layout->attributes, [&input](const VkVertexInputAttributeDescription& attribute)
+                    {
+                        // matrix inputs reflect without a format; their columns are checked by location only
+                        return attribute.location == input.location &&
+                               (input.format == VK_FORMAT_UNDEFINED || attribute.format == input.format);
+                    }))
+                {
+                    Logger::error("Pipeline creation failed: vertex layout does not provide input location {} of '{}'",
+                        input.location, vertex_shader.path);
+                    return std::nullopt;
+                }
+            }
+        }
+
+        std::vector<VkVertexInputBindingDescription> bindings;
+        if (layout != nullptr) bindings = layout->bindings;
+        else if (vert_refl->binding.stride != 0) bindings.push_back(vert_refl->binding);
+
+        const VkPipelineLayout pipeline_layout = acquire_pipeline_layout({ &*vert_refl, &*frag_refl });
+        if (pipeline_layout == nullptr) return std::nullopt;
+
+        return PipelineCreateInfo{
+            .bindings = std::move(bindings),
+            .attributes = layout != nullptr ? layout->attributes : vert_refl->attributes,
+            .layout = pipeline_layout,
             .vertex_shader = vert_refl->module,
             .fragment_shader = frag_refl->module,
-            .polygon_mode = polygon_mode
+            .polygon_mode = polygon_mode,
+            .pipeline_cache = instance().pipeline_cache.get_cache()
         };
+    }
+
+    pipeline_id_t PipelineManager::create_compute_pipeline(const ShaderVariant& compute_shader)
+    {
+        Logger::debug("Creating compute pipeline: {}", compute_shader.path);
+        const auto comp_refl = acquire_shader(compute_shader);
 
-        Pipeline pipe{ create_info };
-        if (pipe.get_pipeline() == nullptr ||
-            pipe.get_layout()   == nullptr)
+        if (!comp_refl || comp_refl->stage != ShaderType::Compute)
+        {
+            Logger::error("Compute pipeline creation failed: '{}' is not a loadable compute shader", compute_shader.path);
             return INVALID_PIPELINE_ID;
+        }
 
-        Logger::debug("Pipeline created");
+        const VkPipelineLayout pipeline_layout = acquire_pipeline_layout({ &*comp_refl });
+        if (pipeline_layout == nullptr) return INVALID_PIPELINE_ID;
 
-        const pipeline_id_t id = inst.next_id++;
-        inst.pipelines.emplace(id, std::move(pipe));
-        return id;
+        return instantiate({
+            .layout = pipeline_layout,
+            .compute_shader = comp_refl->module,
+            .pipeline_cache = instance().pipeline_cache.get_cache()
+        });
+    }
+
+    void PipelineManager::begin_frame()
+    {
+        BOZA_PROFILE_FUNCTION();
+
+        auto& inst = instance();
+
+        std::scoped_lock lock{ inst.mutex };
+
+        std::vector<pipeline_id_t> finished;
+        for (auto& [id, pending] : inst.pending)
+        {
+            if (pending.failed || !pending.build->done.load(std::memory_order_acquire)) continue;
+
+            AsyncBuild& build = *pending.build;
+
+            if (pending.references == 0)
+            {
+                if (build.existing != INVALID_PIPELINE_ID) release(build.existing);
+                finished.push_back(id);
+                continue;
+            }
+
+            if (build.existing == INVALID_PIPELINE_ID && build.pipeline.has_value())
+                build.existing = retain_existing(build.key);
+
+            if (build.existing != INVALID_PIPELINE_ID)
+                inst.aliases.emplace(id, Alias{ .target = build.existing, .references = pending.references });
+            else if (build.pipeline.has_value())
+            {
+                add_pipeline(id, std::move(build.key), std::move(*build.pipeline));
+                inst.pipelines.at(id).references = pending.references;
+            }
+            else
+            {
+                Logger::error("Async pipeline {} failed to build; keeping its fallback", id);
+                pending.failed = true;
+                continue;
+            }
+
+            Logger::debug("Async pipeline {} is ready", id);
+            finished.push_back(id);
+        }
+
+        std::vector<pipeline_id_t> fallbacks;
+        for (const pipeline_id_t id : finished)
+        {
+            fallbacks.push_back(inst.pending.at(id).fallback);
+            inst.pending.erase(id);
+        }
+
+        // a fallback may itself have been published above, so only released once every entry is moved
+        for (const pipeline_id_t fallback : fallbacks)
+            if (fallback != INVALID_PIPELINE_ID) release_handle(fallback);
+
+        std::erase_if(inst.retired, [](RetiredPipeline& retired) { return --retired.frames_left == 0; });
+
+        // frames in flight may still use the fast link, so it is retired rather than destroyed
+        std::erase_if(inst.optimising, [&inst](const Optimisation& optimisation)
+        {
+            AsyncBuild& build = *optimisation.build;
+            if (!build.done.load(std::memory_order_acquire)) return false;
+
+            if (const auto it = inst.pipelines.find(optimisation.id); it != inst.pipelines.end() && build.pipeline.has_value())
+            {
+                inst.retired.push_back({ std::move(it->second.pipeline), Swapchain::max_frames_in_flight });
+                it->second.pipeline = std::move(*build.pipeline);
+            }
+            return true;
+        });
+    }
+
+    pipeline_id_t PipelineManager::resolve(const pipeline_id_t id)
+    {
+        const auto& inst = instance();
+
+        if (inst.pipelines.contains(id)) return id;
+        if (const auto it = inst.aliases.find(id); it != inst.aliases.end()) return it->second.target;
+        // the fallback may be an async handle itself
+        if (const auto it = inst.pending.find(id); it != inst.pending.end()) return resolve(it->second.fallback);
+        return INVALID_PIPELINE_ID;
+    }
+
+    bool PipelineManager::is_ready(const pipeline_id_t id)
+    {
+        const auto& inst = instance();
+        return inst.pipelines.contains(id) || inst.aliases.contains(id);
     }
 
     void PipelineManager::bind_pipeline(const VkCommandBuffer command_buffer, const pipeline_id_t id)
     {
-        vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, get_pipeline(id).get_pipeline());
+        Pipeline& pipeline = get_pipeline(id);
+        vkCmdBindPipeline(command_buffer, pipeline.get_bind_point(), pipeline.get_pipeline());
     }
 
     Pipeline& PipelineManager::get_pipeline(const pipeline_id_t id)
@@ -197,15 +534,328 @@ namespace boza
 
         auto& inst = instance();
         assert(inst.pipelines.contains(id) && "Pipeline not found");
-        return inst.pipelines.at(id);
+        return inst.pipelines.at(id).pipeline;
     }
 
     void PipelineManager::destroy_pipeline(const pipeline_id_t id)
     {
         assert(id != INVALID_PIPELINE_ID && "Invalid pipeline id");
 
+        auto& inst = instance();
+
+        std::scoped_lock lock{ inst.mutex };
+        release_handle(id);
+    }
+
+
+    pipeline_id_t PipelineManager::instantiate(const PipelineCreateInfo& create_info)
+    {
+        auto& inst = instance();
+
+        std::string key = make_pipeline_key(create_info);
+        {
+            std::scoped_lock lock{ inst.mutex };
+            if (const pipeline_id_t existing = retain_existing(key); existing != INVALID_PIPELINE_ID) return existing;
+        }
+
+        auto pipe = compile(create_info, false);
+        if (!pipe.has_value()) return INVALID_PIPELINE_ID;
+
+        Logger::debug("Pipeline created");
+
+        std::scoped_lock lock{ inst.mutex };
+
+        // an async build of the same pipeline may have been published meanwhile
+        if (const pipeline_id_t existing = retain_existing(key); existing != INVALID_PIPELINE_ID) return existing;
+
+        const pipeline_id_t id = inst.next_id++;
+        add_pipeline(id, std::move(key), std::move(*pipe));
+
+        // the fast link is usable right away, begin_frame swaps in the optimised one once it is built
+        if (uses_libraries(create_info))
+        {
+            auto build = std::make_shared<AsyncBuild>();
+
+            const JobSystem::task_id task = JobSystem::push_task([build, create_info]
+            {
+                build->pipeline = compile(create_info, true);
+                build->done.store(true, std::memory_order_release);
+            }, { .priority = JobPriority::Background });
+
+            // without the job the fast link simply stays
+            if (task != JobSystem::INVALID_TASK_ID)
+                inst.optimising.push_back({ .id = id, .build = std::move(build), .task = task });
+        }
+
+        return id;
+    }
+
+    bool PipelineManager::uses_libraries(const PipelineCreateInfo& create_info)
+    {
+        return create_info.compute_shader == nullptr && Device::supports_graphics_pipeline_library();
+    }
+
+    std::optional<Pipeline> PipelineManager::compile(const PipelineCreateInfo& create_info, const bool optimise_link)
+    {
+        if (!uses_libraries(create_info))
+        {
+            Pipeline pipe{ create_info };
+            if (pipe.get_pipeline() == nullptr) return std::nullopt;
+            return pipe;
+        }
+
+        PipelineCreateInfo link_info
+        {
+            .layout = create_info.layout,
+            .pipeline_cache = create_info.pipeline_cache,
+            .optimise_link = optimise_link
+        };
+
+        for (const VkGraphicsPipelineLibraryFlagBitsEXT part : {
+                 VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT,
+                 VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT,
+                 VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT,
+                 VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT })
+        {
+            const VkPipeline library = acquire_library_part(part, create_info);
+            if (library == nullptr) return std::nullopt;
+            link_info.libraries.push_back(library);
+        }
+
+        Pipeline pipe{ link_info };
+        if (pipe.get_pipeline() == nullptr) return std::nullopt;
+        return pipe;
+    }
+
+    VkPipeline PipelineManager::acquire_library_part(const VkGraphicsPipelineLibraryFlagBitsEXT part, const PipelineCreateInfo& create_info)
+    {
+        auto& inst = instance();
+
+        // only the fields a part compiles go into its key, so variants share every part they do not change
+        std::string key;
+        append_key(key, part);
+        switch (part)
+        {
+            case VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT:
+                for (const auto& binding : create_info.bindings)
+                    append_key(key, binding.binding, binding.stride, binding.inputRate);
+                for (const auto& attribute : create_info.attributes)
+                    append_key(key, attribute.location, attribute.binding, attribute.format, attribute.offset);
+                break;
+
+            case VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT:
+                append_key(key, create_info.layout, create_info.vertex_shader, create_info.polygon_mode);
+                break;
+
+            case VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT:
+                append_key(key, create_info.layout, create_info.fragment_shader);
+                break;
+
+            default:
+                break;
+        }
+
+        {
+            std::scoped_lock lock{ inst.mutex };
+            if (const auto it = inst.library_parts.find(key); it != inst.library_parts.end()) return it->second.get_pipeline();
+        }
+
+        PipelineCreateInfo part_info = create_info;
+        part_info.library_parts      = part;
+
+        Pipeline library{ part_info };
+        if (library.get_pipeline() == nullptr) return nullptr;
+
+        std::scoped_lock lock{ inst.mutex };
+        return inst.library_parts.try_emplace(std::move(key), std::move(library)).first->second.get_pipeline();
+    }
+
+    pipeline_id_t PipelineManager::retain_existing(const std::string& key)
+    {
+        auto& inst = instance();
+
+        const auto it = inst.pipeline_ids.find(key);
+        if (it == inst.pipeline_ids.end()) return INVALID_PIPELINE_ID;
+
+        ++inst.pipelines.at(it->second).references;
+        Logger::debug("Reusing pipeline {}", it->second);
+        return it->second;
+    }
+
+    void PipelineManager::add_pipeline(const pipeline_id_t id, std::string key, Pipeline pipeline)
+    {
+        auto& inst = instance();
+
+        inst.pipeline_ids.emplace(key, id);
+        inst.pipelines.emplace(id, PipelineRecord{ .pipeline = std::move(pipeline), .key = std::move(key) });
+        inst.unsaved_pipelines.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void PipelineManager::release(const pipeline_id_t id)
+    {
         auto& inst = instance();
         assert(inst.pipelines.contains(id) && "Pipeline not found");
+
+        auto& record = inst.pipelines.at(id);
+        if (--record.references > 0) return;
+
+        // frames in flight may still be drawing with it
+        inst.retired.push_back({ std::move(record.pipeline), Swapchain::max_frames_in_flight });
+        inst.pipeline_ids.erase(record.key);
         inst.pipelines.erase(id);
     }
+
+    bool PipelineManager::retain_handle(const pipeline_id_t id)
+    {
+        auto& inst = instance();
+
+        if (const auto it = inst.pipelines.find(id); it != inst.pipelines.end()) ++it->second.references;
+        else if (const auto alias = inst.aliases.find(id); alias != inst.aliases.end()) ++alias->second.references;
+        else if (const auto pending = inst.pending.find(id); pending != inst.pending.end() && pending->second.references > 0)
+            ++pending->second.references;
+        else return false;
+
+        return true;
+    }
+
+    void PipelineManager::release_handle(const pipeline_id_t id)
+    {
+        auto& inst = instance();
+
+        // the job cannot be recalled, begin_frame drops its result instead
+        if (const auto it = inst.pending.find(id); it != inst.pending.end())
+        {
+            if (--it->second.references > 0 || !it->second.failed) return;
+
+            const pipeline_id_t fallback = it->second.fallback;
+            inst.pending.erase(it);
+            if (fallback != INVALID_PIPELINE_ID) release_handle(fallback);
+            return;
+        }
+
+        if (const auto it = inst.aliases.find(id); it != inst.aliases.end())
+        {
+            if (--it->second.references > 0) return;
+
+            const pipeline_id_t target = it->second.target;
+            inst.aliases.erase(it);
+            release(target);
+            return;
+        }
+
+        release(id);
+    }
+
+
+    std::optional<ShaderReflectionInfo> PipelineManager::acquire_shader(const ShaderVariant& variant)
+    {
+        auto& inst = instance();
+
+        // one module per permutation of each file
+        std::string key = fmt::format("{}#{:x}", variant.path, variant.keywords);
+        {
+            std::scoped_lock lock{ inst.mutex };
+            if (const auto it = inst.shaders.find(key); it != inst.shaders.end()) return it->second;
+        }
+
+        // compiled without the lock; if another build got there first its module wins
+        auto shader = ShaderLoader::load_shader(variant);
+        if (!shader.has_value()) return std::nullopt;
+
+        std::scoped_lock lock{ inst.mutex };
+        const auto [it, inserted] = inst.shaders.try_emplace(std::move(key), *shader);
+        if (!inserted) ShaderLoader::destroy_shader_module(shader->module);
+        return it->second;
+    }
+
+    VkDescriptorSetLayout PipelineManager::acquire_set_layout(const std::vector<VkDescriptorSetLayoutBinding>& bindings)
+    {
+        auto& inst = instance();
+
+        std::string key;
+        for (const auto& binding : bindings)
+            append_key(key, binding.binding, binding.descriptorType, binding.descriptorCount, binding.stageFlags);
+
+        if (const auto it = inst.set_layouts.find(key); it != inst.set_layouts.end()) return it->second;
+
+        const VkDescriptorSetLayoutCreateInfo info
+        {
+            .sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+            .pNext        = nullptr,
+            .flags        = 0,
+            .bindingCount = static_cast<uint32_t>(bindings.size()),
+            .pBindings    = bindings.data()
+        };
+
+        VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+        VK_CHECK(vkCreateDescriptorSetLayout(Device::get_device(), &info, nullptr, &layout),
+        {
+            LOG_VK_ERROR("Failed to create descriptor set layout");
+            return nullptr;
+        });
+
+        inst.set_layouts.emplace(std::move(key), layout);
+        return layout;
+    }
+
+    VkPipelineLayout PipelineManager::acquire_pipeline_layout(const std::initializer_list<const ShaderReflectionInfo*> stages)
+    {
+        auto& inst = instance();
+
+        std::scoped_lock lock{ inst.mutex };
+
+        const auto per_set        = merge_set_bindings(stages);
+        const auto push_constants = merge_push_constants(stages);
+
+        // sets the shaders skip still need a layout, an empty one is compatible with anything bound there
+        std::vector<VkDescriptorSetLayout> set_layouts(per_set.empty() ? 0 : per_set.rbegin()->first + 1);
+        for (uint32_t set = 0; set < set_layouts.size(); ++set)
+        {
+            const auto it    = per_set.find(set);
+            set_layouts[set] = acquire_set_layout(it != per_set.end() ? it->second : std::vector<VkDescriptorSetLayoutBinding>{});
+            if (set_layouts[set] == nullptr) return nullptr;
+        }
+
+        std::string key;
+        for (const VkDescriptorSetLayout set_layout : set_layouts)
+            append_key(key, set_layout);
+        for (const VkPushConstantRange& range : push_constants)
+            append_key(key, range.stageFlags, range.offset, range.size);
+
+        if (const auto it = inst.pipeline_layouts.find(key); it != inst.pipeline_layouts.end()) return it->second;
+
+        const VkPipelineLayoutCreateInfo layout_info
+        {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = {},
+            .setLayoutCount = static_cast<uint32_t>(set_layouts.size()),
+            .pSetLayouts = set_layouts.data(),
+            .pushConstantRangeCount = static_cast<uint32_t>(push_constants.size()),
+            .pPushConstantRanges = push_constants.data(),
+        };
+
+        VkPipelineLayout layout = VK_NULL_HANDLE;
+        VK_CHECK(vkCreatePipelineLayout(Device::get_device(), &layout_info, nullptr, &layout),
+        {
+            LOG_VK_ERROR("Failed to create pipeline layout");
+            return nullptr;
+        });
+
+        inst.pipeline_layouts.emplace(std::move(key), layout);
+        return layout;
+    }
+
+    std::string PipelineManager::make_pipeline_key(const PipelineCreateInfo& create_info)
+    {
+        // layouts and modules are deduplicated already, so their handles stand in for their contents
+        std::string key;
+        append_key(key, create_info.layout, create_info.vertex_shader, create_info.fragment_shader,
+                   create_info.compute_shader, create_info.polygon_mode);
+        for (const auto& binding : create_info.bindings)
+            append_key(key, binding.binding, binding.stride, binding.inputRate);
+        for (const auto& attribute : create_info.attributes)
+            append_key(key, attribute.location, attribute.binding, attribute.format, attribute.offset);
+        return key;
+    }
 }
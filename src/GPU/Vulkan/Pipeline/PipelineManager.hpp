@@ -2,30 +2,190 @@
 #include "boza_pch.hpp"
 #include "Singleton.hpp"
 #include "Pipeline.hpp"
+#include "PipelineCache.hpp"
+#include "ShaderLoader.hpp"
+#include "Core/JobSystem/JobSystem.hpp"
+#include "GPU/Vulkan/Vertex/VertexLayout.hpp"
 
 namespace boza
 {
     using pipeline_id_t                         = uint32_t;
     constexpr pipeline_id_t INVALID_PIPELINE_ID = std::numeric_limits<pipeline_id_t>::max();
 
+    // Shader modules, descriptor set layouts and pipeline layouts are shared between pipelines, and requests that
+    // resolve to an identical pipeline return the existing id. Ids are reference counted, so destroy_pipeline only
+    // releases a pipeline once every create that returned its id has been matched. Released pipelines are destroyed
+    // max_frames_in_flight frames later, once no frame in flight can still be drawing with them.
     class PipelineManager final : public Singleton<PipelineManager>
     {
     public:
+        // Writes the pipeline cache back before destroying everything.
         static void cleanup();
 
+        // Call once the device exists and before the first pipeline is created.
+        [[nodiscard]] static bool load_pipeline_cache(const fs::path& path = default_pipeline_cache_path);
+        [[nodiscard]] static bool save_pipeline_cache();
+        // Saves on a background worker when pipelines were added since the last save and the interval has passed.
+        static void autosave_pipeline_cache();
+
+        // Compiles the shader permutations listed in a manifest on background workers, so later creates find them
+        // loaded. Format: { "shaders": [ { "path": "shaders/default.frag", "variants": [ [], [ "INVERT" ] ] } ] }
+        [[nodiscard]] static bool prewarm(const fs::path& manifest);
+
         static pipeline_id_t create_pipeline(
-            const std::string&                 vertex_shader,
-            const std::string&                 fragment_shader,
+            const ShaderVariant&               vertex_shader,
+            const ShaderVariant&               fragment_shader,
             VkPolygonMode                      polygon_mode = VK_POLYGON_MODE_FILL);
 
+        // Takes the vertex input from layout instead of reflection, e.g. to feed some attributes per instance.
+        static pipeline_id_t create_pipeline(
+            const ShaderVariant&               vertex_shader,
+            const ShaderVariant&               fragment_shader,
+            const VertexLayout&                layout,
+            VkPolygonMode                      polygon_mode = VK_POLYGON_MODE_FILL);
+
+        // Returns at once and builds on a background worker. Until begin_frame publishes the result the id resolves
+        // to fallback, or to INVALID_PIPELINE_ID when there is none and the draws should be skipped. A build that
+        // fails keeps resolving to its fallback. The fallback is retained until the build is published or dropped,
+        // so destroying it meanwhile is safe. INVALID_PIPELINE_ID if the build could not be queued.
+        static pipeline_id_t create_pipeline_async(
+            const ShaderVariant&               vertex_shader,
+            const ShaderVariant&               fragment_shader,
+            VkPolygonMode                      polygon_mode = VK_POLYGON_MODE_FILL,
+            pipeline_id_t                      fallback     = INVALID_PIPELINE_ID);
+
+        static pipeline_id_t create_pipeline_async(
+            const ShaderVariant&               vertex_shader,
+            const ShaderVariant&               fragment_shader,
+            const VertexLayout&                layout,
+            VkPolygonMode                      polygon_mode = VK_POLYGON_MODE_FILL,
+            pipeline_id_t                      fallback     = INVALID_PIPELINE_ID);
+
+        static pipeline_id_t create_compute_pipeline(const ShaderVariant& compute_shader);
+
+        // Publishes finished async builds, so a handle only ever switches between frames.
+        static void begin_frame();
+
+        // The id to bind this frame for any handle; get_pipeline and bind_pipeline only take resolved ids.
+        [[nodiscard]] static pipeline_id_t resolve(pipeline_id_t id);
+        [[nodiscard]] static bool          is_ready(pipeline_id_t id);
+
+        // Binds to the pipeline's own bind point, graphics or compute.
         static void      bind_pipeline(VkCommandBuffer command_buffer, pipeline_id_t id);
         static Pipeline& get_pipeline(pipeline_id_t id);
         static void      destroy_pipeline(pipeline_id_t id);
 
     private:
-        hash_map<pipeline_id_t, Pipeline>     pipelines;
-        hash_map<std::string, VkShaderModule> shader_modules;
-        pipeline_id_t                         next_id{ 0 };
+        static constexpr auto       autosave_interval             = 30s;
+        static constexpr const char default_pipeline_cache_path[] = "cache/pipelines.bin";
+
+        static pipeline_id_t build_pipeline(
+            const ShaderVariant& vertex_shader,
+            const ShaderVariant& fragment_shader,
+            const VertexLayout*  layout,
+            VkPolygonMode        polygon_mode);
+
+        static pipeline_id_t build_pipeline_async(
+            const ShaderVariant&               vertex_shader,
+            const ShaderVariant&               fragment_shader,
+            const std::optional<VertexLayout>& layout,
+            VkPolygonMode                      polygon_mode,
+            pipeline_id_t                      fallback);
+
+        // Safe on any thread, so async builds run it on workers.
+        static std::optional<PipelineCreateInfo> prepare_pipeline(
+            const ShaderVariant& vertex_shader,
+            const ShaderVariant& fragment_shader,
+            const VertexLayout*  layout,
+            VkPolygonMode        polygon_mode);
+
+        static std::optional<ShaderReflectionInfo> acquire_shader(const ShaderVariant& variant);
+        // Expects the mutex to be held, unlike the rest of this group.
+        static VkDescriptorSetLayout               acquire_set_layout(const std::vector<VkDescriptorSetLayoutBinding>& bindings);
+        static VkPipelineLayout                    acquire_pipeline_layout(std::initializer_list<const ShaderReflectionInfo*> stages);
+        static std::string                         make_pipeline_key(const PipelineCreateInfo& create_info);
+        static pipeline_id_t                       instantiate(const PipelineCreateInfo& create_info);
+
+        // Graphics pipelines are linked from cached library parts when the device supports them.
+        static bool                    uses_libraries(const PipelineCreateInfo& create_info);
+        static std::optional<Pipeline> compile(const PipelineCreateInfo& create_info, bool optimise_link);
+        static VkPipeline              acquire_library_part(VkGraphicsPipelineLibraryFlagBitsEXT part, const PipelineCreateInfo& create_info);
+
+        // Expect the mutex to be held. The *_handle variants accept pending and alias ids too.
+        static pipeline_id_t retain_existing(const std::string& key);
+        static void          add_pipeline(pipeline_id_t id, std::string key, Pipeline pipeline);
+        static void          release(pipeline_id_t id);
+        static bool          retain_handle(pipeline_id_t id);
+        static void          release_handle(pipeline_id_t id);
+
+        struct PipelineRecord
+        {
+            Pipeline    pipeline;
+            std::string key;
+            uint32_t    references{ 1 };
+        };
+
+        // filled by a worker; done publishes the other fields to the render thread
+        struct AsyncBuild
+        {
+            std::atomic_bool        done{ false };
+            std::optional<Pipeline> pipeline;
+            std::string             key;
+            pipeline_id_t           existing{ INVALID_PIPELINE_ID };
+        };
+
+        struct PendingPipeline
+        {
+            std::shared_ptr<AsyncBuild> build;
+            JobSystem::task_id          task{ JobSystem::INVALID_TASK_ID };
+            pipeline_id_t               fallback{ INVALID_PIPELINE_ID };
+            bool                        failed{ false };
+            // 0 once destroyed; begin_frame then drops the result
+            uint32_t                    references{ 1 };
+        };
+
+        // an async id whose build matched an existing pipeline; holds one reference to target
+        struct Alias
+        {
+            pipeline_id_t target;
+            uint32_t      references{ 1 };
+        };
+
+        struct Optimisation
+        {
+            pipeline_id_t               id;
+            std::shared_ptr<AsyncBuild> build;
+            JobSystem::task_id          task;
+        };
+
+        struct RetiredPipeline
+        {
+            Pipeline pipeline;
+            uint32_t frames_left;
+        };
+
+        // Workers only look entries up, structural changes to pipelines happen on the render thread under the
+        // mutex, so render-thread reads need no lock. pending, aliases, optimising and retired are render-thread only.
+        std::mutex                                   mutex;
+        hash_map<pipeline_id_t, PipelineRecord>      pipelines;
+        hash_map<std::string, pipeline_id_t>         pipeline_ids;
+        hash_map<pipeline_id_t, PendingPipeline>     pending;
+        hash_map<pipeline_id_t, Alias>               aliases;
+        hash_map<std::string, ShaderReflectionInfo>  shaders;
+        hash_map<std::string, VkDescriptorSetLayout> set_layouts;
+        hash_map<std::string, VkPipelineLayout>      pipeline_layouts;
+        hash_map<std::string, Pipeline>              library_parts;
+        std::vector<Optimisation>                    optimising;
+        std::vector<RetiredPipeline>                 retired;
+        pipeline_id_t                                next_id{ 0 };
+
+        PipelineCache        pipeline_cache{};
+        std::atomic_uint32_t unsaved_pipelines{ 0 };
+        std::atomic_bool     saving{ false };
+        JobSystem::task_id   save_task{ JobSystem::INVALID_TASK_ID };
+        time_point           last_save{};
+
+        std::vector<JobSystem::task_id> prewarm_tasks;
 
         friend Singleton;
         PipelineManager() = default;
@@ -0,0 +1,198 @@
+#include "ShaderCache.hpp"
+
+#include "Logger.hpp"
+#include "Profiler.hpp"
+
+namespace boza
+{
+    std::optional<CachedShader> ShaderCache::load(const uint64_t key)
+    {
+        BOZA_PROFILE_FUNCTION();
+
+        const fs::path path = entry_path(key);
+
+        std::ifstream file{ path, std::ios::binary };
+        if (!file.is_open()) return std::nullopt;
+
+        const std::vector<uint8_t> contents{ std::istreambuf_iterator(file), std::istreambuf_iterator<char>() };
+
+        const json entry = json::from_cbor(contents, true, false);
+        if (entry.is_discarded() || !entry.is_object())
+        {
+            Logger::warn("Ignoring shader cache entry '{}': corrupted", path.string());
+            return std::nullopt;
+        }
+
+        try
+        {
+            if (entry.at("format").get<uint32_t>() != format_version || entry.at("key").get<uint64_t>() != key)
+                return std::nullopt;
+
+            const auto& bytes = entry.at("spirv").get_binary();
+            if (bytes.empty() || bytes.size() % sizeof(uint32_t) != 0)
+            {
+                Logger::warn("Ignoring shader cache entry '{}': bad SPIR-V size", path.string());
+                return std::nullopt;
+            }
+
+            CachedShader shader;
+            shader.spirv.resize(bytes.size() / sizeof(uint32_t));
+            memcpy(shader.spirv.data(), bytes.data(), bytes.size());
+            shader.reflection = reflection_from_json(entry.at("reflection"));
+            return shader;
+        }
+        catch (const json::exception& e)
+        {
+            Logger::warn("Ignoring shader cache entry '{}': {}", path.string(), e.what());
+            return std::nullopt;
+        }
+    }
+
+    bool ShaderCache::store(const uint64_t key, const CachedShader& shader)
+    {
+        BOZA_PROFILE_FUNCTION();
+
+        const auto* first = reinterpret_cast<const uint8_t*>(shader.spirv.data());
+
+        const json entry
+        {
+            { "format", format_version },
+            { "key", key },
+            { "spirv", json::binary(std::vector<uint8_t>{ first, first + shader.spirv.size() * sizeof(uint32_t) }) },
+            { "reflection", reflection_to_json(shader.reflection) }
+        };
+        const std::vector<uint8_t> data = json::to_cbor(entry);
+
+        const fs::path path = entry_path(key);
+
+        std::error_code error;
+        fs::create_directories(path.parent_path(), error);
+
+        // several workers may store the same key at once, so each writes its own temporary
+        fs::path temporary = path;
+        temporary += fmt::format(".{}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+        {
+            std::ofstream file{ temporary, std::ios::binary | std::ios::trunc };
+            file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+            if (!file)
+            {
+                Logger::warn("Failed to write shader cache entry '{}'", temporary.string());
+                return false;
+            }
+        }
+
+        fs::rename(temporary, path, error);
+        if (error)
+        {
+            Logger::warn("Failed to replace shader cache entry '{}': {}", path.string(), error.message());
+            fs::remove(temporary, error);
+            return false;
+        }
+
+        return true;
+    }
+
+    uint64_t ShaderCache::hash(const std::string_view data, const uint64_t seed)
+    {
+        uint64_t value = seed;
+        for (const char c : data)
+        {
+            value ^= static_cast<uint8_t>(c);
+            value *= 0x0000'0100'0000'01B3ull;
+        }
+        return value;
+    }
+
+
+    fs::path ShaderCache::entry_path(const uint64_t key)
+    {
+        return fs::path{ cache_directory } / fmt::format("{:016x}.bin", key);
+    }
+
+
+    json ShaderCache::reflection_to_json(const ShaderReflectionInfo& info)
+    {
+        json descriptors = json::array();
+        for (const auto& d : info.descriptors)
+        {
+            descriptors.push_back({
+                { "set", d.set },
+                { "binding", d.binding },
+                { "type", d.type },
+                { "array_count", d.array_count },
+                { "byte_size", d.byte_size },
+                { "name", d.name }
+            });
+        }
+
+        json push_constants = json::array();
+        for (const auto& pc : info.push_constants)
+            push_constants.push_back({ { "stage", pc.stageFlags }, { "offset", pc.offset }, { "size", pc.size } });
+
+        json attributes = json::array();
+        for (const auto& a : info.attributes)
+        {
+            attributes.push_back({
+                { "location", a.location },
+                { "binding", a.binding },
+                { "format", a.format },
+                { "offset", a.offset }
+            });
+        }
+
+        return {
+            { "stage", info.stage },
+            { "descriptors", std::move(descriptors) },
+            { "push_constants", std::move(push_constants) },
+            { "binding", { { "binding", info.binding.binding }, { "stride", info.binding.stride }, { "input_rate", info.binding.inputRate } } },
+            { "attributes", std::move(attributes) }
+        };
+    }
+
+    ShaderReflectionInfo ShaderCache::reflection_from_json(const json& j)
+    {
+        ShaderReflectionInfo info;
+        info.stage = j.at("stage").get<ShaderType>();
+
+        for (const auto& d : j.at("descriptors"))
+        {
+            info.descriptors.push_back({
+                .set = d.at("set").get<uint32_t>(),
+                .binding = d.at("binding").get<uint32_t>(),
+                .type = d.at("type").get<VkDescriptorType>(),
+                .array_count = d.at("array_count").get<uint32_t>(),
+                .byte_size = d.at("byte_size").get<uint32_t>(),
+                .name = d.at("name").get<std::string>()
+            });
+        }
+
+        for (const auto& pc : j.at("push_constants"))
+        {
+            info.push_constants.push_back({
+                .stageFlags = pc.at("stage").get<VkShaderStageFlags>(),
+                .offset = pc.at("offset").get<uint32_t>(),
+                .size = pc.at("size").get<uint32_t>()
+            });
+        }
+
+        const auto& binding = j.at("binding");
+        info.binding = {
+            .binding = binding.at("binding").get<uint32_t>(),
+            .stride = binding.at("stride").get<uint32_t>(),
+            .inputRate = binding.at("input_rate").get<VkVertexInputRate>()
+        };
+
+        for (const auto& a : j.at("attributes"))
+        {
+            info.attributes.push_back({
+                .location = a.at("location").get<uint32_t>(),
+                .binding = a.at("binding").get<uint32_t>(),
+                .format = a.at("format").get<VkFormat>(),
+                .offset = a.at("offset").get<uint32_t>()
+            });
+        }
+
+        return info;
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include "boza_pch.hpp"
+#include "ShaderLoader.hpp"
+
+namespace boza
+{
+    struct CachedShader
+    {
+        std::vector<uint32_t> spirv;
+        ShaderReflectionInfo  reflection;
+    };
+
+    // Disk cache of optimised SPIR-V plus its reflection, one file per key under cache/shaders. The key is
+    // produced by ShaderLoader and covers everything the output depends on, so entries are never invalidated,
+    // only superseded.
+    class ShaderCache final
+    {
+    public:
+        // Entries that are missing, truncated or written by another cache format count as misses.
+        [[nodiscard]] static std::optional<CachedShader> load(uint64_t key);
+        // reflection.module is not stored.
+        static bool store(uint64_t key, const CachedShader& shader);
+
+        // FNV-1a, chained through seed to hash several inputs into one key.
+        [[nodiscard]] static uint64_t hash(std::string_view data, uint64_t seed = hash_seed);
+
+        static constexpr uint64_t hash_seed = 0xCBF2'9CE4'8422'2325ull;
+
+    private:
+        // Bump whenever reflection or the stored layout changes.
+        static constexpr uint32_t   format_version    = 1;
+        static constexpr const char cache_directory[] = "cache/shaders";
+
+        [[nodiscard]] static fs::path entry_path(uint64_t key);
+
+        [[nodiscard]] static json                 reflection_to_json(const ShaderReflectionInfo& info);
+        [[nodiscard]] static ShaderReflectionInfo reflection_from_json(const json& j);
+    };
+}
@@ -1,155 +1,136 @@
 #include "ShaderLoader.hpp"
 
+#include "ShaderCache.hpp"
 #include "GPU/Vulkan/Core/Device.hpp"
 #include "Logger.hpp"
+#include "Profiler.hpp"
 
 namespace boza
 {
-    std::optional<ShaderReflectionInfo> ShaderLoader::load_shader(const std::string_view& path)
+    namespace
     {
-        const fs::path file_path = path;
-
-        if (!exists(file_path))
+        class Includer final : public shaderc::CompileOptions::IncluderInterface
         {
-            Logger::critical("Shader file not found: {}", file_path.string());
-            return std::nullopt;
-        }
+        public:
+            explicit Includer(fs::path include_directory) : include_directory{ std::move(include_directory) } {}
+
+            shaderc_include_result* GetInclude(
+                const char*          requested_source,
+                shaderc_include_type type,
+                const char*          requesting_source,
+                size_t) override
+            {
+                auto* include = new Include;
+
+                const fs::path path = type == shaderc_include_type_relative
+                    ? fs::path{ requesting_source }.parent_path() / requested_source
+                    : include_directory / requested_source;
+
+                if (std::ifstream file{ path }; file.is_open())
+                {
+                    include->name    = path.lexically_normal().generic_string();
+                    include->content = std::string{ std::istreambuf_iterator(file), std::istreambuf_iterator<char>() };
+                }
+                else
+                    include->content = fmt::format("cannot open include file '{}'", path.string());
+
+                // an empty source_name tells shaderc the include failed and content holds the error
+                include->result = {
+                    .source_name = include->name.c_str(),
+                    .source_name_length = include->name.size(),
+                    .content = include->content.c_str(),
+                    .content_length = include->content.size(),
+                    .user_data = include
+                };
+                return &include->result;
+            }
 
-        const auto source = read_source(file_path);
-        if (source.empty()) return std::nullopt;
+            void ReleaseInclude(shaderc_include_result* data) override
+            {
+                delete static_cast<Include*>(data->user_data);
+            }
 
-        auto spirv = compile_to_spirv(file_path, source);
-        if (spirv.empty()) return std::nullopt;
+        private:
+            struct Include
+            {
+                std::string            name;
+                std::string            content;
+                shaderc_include_result result{};
+            };
 
-        if (!validate_spirv(spirv, file_path)) return std::nullopt;
+            fs::path include_directory;
+        };
+    }
 
-        spirv = optimise_spirv(spirv, file_path);
-        if (spirv.empty()) return std::nullopt;
 
-        const VkShaderModuleCreateInfo create_info
-        {
-            .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
-            .pNext = nullptr,
-            .flags = {},
-            .codeSize = spirv.size() * sizeof(uint32_t),
-            .pCode = spirv.data()
-        };
+    std::optional<ShaderReflectionInfo> ShaderLoader::load_shader(const ShaderVariant& variant)
+    {
+        BOZA_PROFILE_FUNCTION();
+
+        const fs::path file_path = variant.path;
 
-        VkShaderModule vk_module = VK_NULL_HANDLE;
-        VK_CHECK(vkCreateShaderModule(Device::get_device(), &create_info, nullptr, &vk_module),
+        if (!exists(file_path))
         {
-            LOG_VK_ERROR("Failed to create shader module");
+            Logger::critical("Shader file not found: {}", file_path.string());
             return std::nullopt;
-        });
+        }
 
-        SpvReflectShaderModule refl_mod{};
-        if (spvReflectCreateShaderModule(create_info.codeSize, create_info.pCode, &refl_mod) != SPV_REFLECT_RESULT_SUCCESS)
+        const auto source = read_source(file_path);
+        if (source.empty()) return std::nullopt;
+
+        const auto keywords = parse_keywords(source);
+        if (keywords.size() < std::numeric_limits<keyword_mask_t>::digits && variant.keywords >> keywords.size() != 0)
         {
-            Logger::critical("SPIRV-Reflect failed to create module for '{}'", file_path.string());
-            vkDestroyShaderModule(Device::get_device(), vk_module, nullptr);
+            Logger::critical("Shader '{}' declares {} keywords, mask {:#x} enables others", file_path.string(),
+                             keywords.size(), variant.keywords);
             return std::nullopt;
         }
 
+        // the macros are expanded by the preprocessor, so every permutation gets its own cache key
+        const shaderc::CompileOptions options = make_compile_options(keywords, variant.keywords);
 
-        ShaderReflectionInfo result;
-        result.module = vk_module;
-        result.stage  = deduce_shader_stage(file_path);
+        // preprocessing is cheap and folds every resolved include into the key
+        const auto preprocessed = preprocess(file_path, source, options);
+        if (preprocessed.empty()) return std::nullopt;
 
-        uint32_t binding_count = 0;
-        spvReflectEnumerateDescriptorBindings(&refl_mod, &binding_count, nullptr);
-        std::vector<SpvReflectDescriptorBinding*> bindings(binding_count);
-        spvReflectEnumerateDescriptorBindings(&refl_mod, &binding_count, bindings.data());
+        const uint64_t key = make_cache_key(file_path, preprocessed);
 
-        result.descriptors.reserve(binding_count);
-        for (const auto* b : bindings)
+        auto shader = ShaderCache::load(key);
+        if (shader.has_value())
+            Logger::debug("Loaded '{}' from the shader cache", file_path.string());
+        else
         {
-            DescriptorBindingInfo info;
-            info.set         = b->set;
-            info.binding     = b->binding;
-            info.array_count = b->count;
-            info.name        = b->name ? b->name : "";
+            auto spirv = compile_to_spirv(file_path, preprocessed, options);
+            if (spirv.empty()) return std::nullopt;
 
-            switch (b->descriptor_type)
-            {
-                case SPV_REFLECT_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
-                    info.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-                    info.byte_size = b->block.size;
-                    break;
+            if (!validate_spirv(spirv, file_path)) return std::nullopt;
 
-                case SPV_REFLECT_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
-                    info.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-                    break;
+            spirv = optimise_spirv(spirv, file_path);
+            if (spirv.empty()) return std::nullopt;
 
-                case SPV_REFLECT_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
-                    info.type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-                    break;
-
-                case SPV_REFLECT_DESCRIPTOR_TYPE_SAMPLER:
-                    info.type = VK_DESCRIPTOR_TYPE_SAMPLER;
-                    break;
-
-                case SPV_REFLECT_DESCRIPTOR_TYPE_STORAGE_BUFFER:
-                    info.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-                    info.byte_size = b->block.size;
-                    break;
-
-                default:
-                    info.type = VK_DESCRIPTOR_TYPE_MAX_ENUM;
-                    break;
-            }
+            auto reflection = reflect(spirv, file_path);
+            if (!reflection.has_value()) return std::nullopt;
 
-            result.descriptors.emplace_back(std::move(info));
+            shader = CachedShader{ .spirv = std::move(spirv), .reflection = std::move(*reflection) };
+            ShaderCache::store(key, *shader);
         }
 
-        uint32_t pc_blocks = 0;
-        spvReflectEnumeratePushConstantBlocks(&refl_mod, &pc_blocks, nullptr);
-        std::vector<SpvReflectBlockVariable*> pcs(pc_blocks);
-        spvReflectEnumeratePushConstantBlocks(&refl_mod, &pc_blocks, pcs.data());
-
-        result.push_constants.reserve(pc_blocks);
-        for (const auto* pc : pcs)
+        const VkShaderModuleCreateInfo create_info
         {
-            VkPushConstantRange range{
-                .stageFlags = static_cast<VkShaderStageFlags>(result.stage),
-                .offset = pc->offset,
-                .size = pc->size
-            };
-            result.push_constants.emplace_back(range);
-        }
+            .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = {},
+            .codeSize = shader->spirv.size() * sizeof(uint32_t),
+            .pCode = shader->spirv.data()
+        };
 
-        if (result.stage == ShaderType::Vertex)
+        VK_CHECK(vkCreateShaderModule(Device::get_device(), &create_info, nullptr, &shader->reflection.module),
         {
-            uint32_t var_cnt = 0;
-            spvReflectEnumerateInputVariables(&refl_mod, &var_cnt, nullptr);
-            std::vector<SpvReflectInterfaceVariable*> vars(var_cnt);
-            spvReflectEnumerateInputVariables(&refl_mod, &var_cnt, vars.data());
-
-            std::ranges::sort(vars, {}, [](auto* v){ return v->location; });
-
-            uint32_t current_offset = 0;
-            result.binding.binding   = 0;
-            result.binding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-            result.attributes.reserve(var_cnt);
-            for (auto* v : vars)
-            {
-                const uint32_t size_in_bytes = (v->numeric.scalar.width >> 3) * v->numeric.vector.component_count;
-
-                result.attributes.emplace_back(
-                    v->location,
-                    0,
-                    static_cast<VkFormat>(v->format),
-                    current_offset
-                );
-
-                current_offset += size_in_bytes;
-            }
-            result.binding.stride = current_offset;
-        }
-
+            LOG_VK_ERROR("Failed to create shader module");
+            return std::nullopt;
+        });
 
-        spvReflectDestroyShaderModule(&refl_mod);
-        return result;
+        return std::move(shader->reflection);
     }
 
     void ShaderLoader::destroy_shader_module(const VkShaderModule& shader_module)
@@ -198,13 +179,112 @@ namespace boza
         };
     }
 
-    std::vector<uint32_t> ShaderLoader::compile_to_spirv(const fs::path& file_path, const std::string& source)
+    std::optional<keyword_mask_t> ShaderLoader::make_keyword_mask(const std::string_view& path, const std::span<const std::string> names)
     {
-        const shaderc::Compiler compiler;
+        const auto source = read_source(path);
+        if (source.empty()) return std::nullopt;
+
+        const auto keywords = parse_keywords(source);
+
+        keyword_mask_t mask = 0;
+        for (const auto& name : names)
+        {
+            const auto it = std::ranges::find(keywords, name);
+            if (it == keywords.end())
+            {
+                Logger::error("Shader '{}' does not declare keyword '{}'", path, name);
+                return std::nullopt;
+            }
+            mask |= keyword_mask_t{ 1 } << (it - keywords.begin());
+        }
+        return mask;
+    }
+
+    std::vector<std::string> ShaderLoader::parse_keywords(const std::string& source)
+    {
+        constexpr std::string_view directive = "#pragma keywords";
+
+        std::vector<std::string> keywords;
+
+        std::istringstream lines{ source };
+        for (std::string line; std::getline(lines, line);)
+        {
+            const auto first = line.find_first_not_of(" \t");
+            if (first == std::string::npos || line.compare(first, directive.size(), directive) != 0) continue;
+
+            std::istringstream names{ line.substr(first + directive.size()) };
+            for (std::string name; names >> name;)
+                keywords.push_back(std::move(name));
+        }
+
+        if (keywords.size() > std::numeric_limits<keyword_mask_t>::digits)
+        {
+            Logger::warn("Only the first {} shader keywords can be enabled", std::numeric_limits<keyword_mask_t>::digits);
+            keywords.resize(std::numeric_limits<keyword_mask_t>::digits);
+        }
+
+        return keywords;
+    }
+
+    shaderc::CompileOptions ShaderLoader::make_compile_options(const std::vector<std::string>& keywords, const keyword_mask_t enabled)
+    {
+        // anything configured here must also be reflected in make_cache_key or the preprocessed source
         shaderc::CompileOptions options;
         options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_3);
         options.SetOptimizationLevel(shaderc_optimization_level_zero);
         options.SetGenerateDebugInfo();
+        options.SetIncluder(std::make_unique<Includer>(include_directory));
+
+        for (size_t i = 0; i < keywords.size(); ++i)
+            options.AddMacroDefinition(keywords[i], (enabled >> i & 1) != 0 ? "1" : "0");
+
+        return options;
+    }
+
+    std::string ShaderLoader::preprocess(const fs::path& file_path, const std::string& source, const shaderc::CompileOptions& options)
+    {
+        BOZA_PROFILE_FUNCTION();
+
+        const shaderc::Compiler                            compiler;
+        const shaderc::PreprocessedSourceCompilationResult result = compiler.PreprocessGlsl(
+            source, deduce_shader_kind(file_path),
+            file_path.string().c_str(),
+            options);
+
+        if (result.GetCompilationStatus() != shaderc_compilation_status_success)
+        {
+            Logger::critical("shaderc preprocessing failed for '{}':\n{}",
+                             file_path.string(),
+                             result.GetErrorMessage());
+            return "";
+        }
+
+        return std::string{ result.cbegin(), result.cend() };
+    }
+
+    uint64_t ShaderLoader::make_cache_key(const fs::path& file_path, const std::string& preprocessed)
+    {
+        static const std::string toolchain = []
+        {
+            unsigned int spv_version = 0, spv_revision = 0;
+            shaderc_get_spv_version(&spv_version, &spv_revision);
+            return fmt::format("shaderc spv {}.{}; {}", spv_version, spv_revision, spvSoftwareVersionDetailsString());
+        }();
+
+        constexpr std::string_view compile_options = "vulkan1.3;O0;g;validate;performance-passes";
+
+        uint64_t key = ShaderCache::hash(toolchain);
+        key = ShaderCache::hash(compile_options, key);
+        key = ShaderCache::hash(fmt::format("{}", static_cast<int>(deduce_shader_kind(file_path))), key);
+        key = ShaderCache::hash(preprocessed, key);
+        return key;
+    }
+
+    std::vector<uint32_t> ShaderLoader::compile_to_spirv(const fs::path& file_path, const std::string& source, const shaderc::CompileOptions& options)
+    {
+        BOZA_PROFILE_FUNCTION();
+
+        const shaderc::Compiler compiler;
 
         const shaderc_shader_kind           kind   = deduce_shader_kind(file_path);
         const shaderc::SpvCompilationResult result = compiler.CompileGlslToSpv(
@@ -259,4 +339,115 @@ namespace boza
 
         return optimised;
     }
+
+    std::optional<ShaderReflectionInfo> ShaderLoader::reflect(const std::vector<uint32_t>& spirv, const fs::path& file_path)
+    {
+        SpvReflectShaderModule refl_mod{};
+        if (spvReflectCreateShaderModule(spirv.size() * sizeof(uint32_t), spirv.data(), &refl_mod) != SPV_REFLECT_RESULT_SUCCESS)
+        {
+            Logger::critical("SPIRV-Reflect failed to create module for '{}'", file_path.string());
+            return std::nullopt;
+        }
+
+
+        ShaderReflectionInfo result;
+        result.stage = deduce_shader_stage(file_path);
+
+        uint32_t binding_count = 0;
+        spvReflectEnumerateDescriptorBindings(&refl_mod, &binding_count, nullptr);
+        std::vector<SpvReflectDescriptorBinding*> bindings(binding_count);
+        spvReflectEnumerateDescriptorBindings(&refl_mod, &binding_count, bindings.data());
+
+        result.descriptors.reserve(binding_count);
+        for (const auto* b : bindings)
+        {
+            DescriptorBindingInfo info;
+            info.set         = b->set;
+            info.binding     = b->binding;
+            info.array_count = b->count;
+            info.name        = b->name ? b->name : "";
+
+            switch (b->descriptor_type)
+            {
+                // every uniform block is fed from the UniformRing through a dynamic offset
+                case SPV_REFLECT_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+                    info.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+                    info.byte_size = b->block.size;
+                    break;
+
+                case SPV_REFLECT_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+                    info.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+                    break;
+
+                case SPV_REFLECT_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+                    info.type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+                    break;
+
+                case SPV_REFLECT_DESCRIPTOR_TYPE_SAMPLER:
+                    info.type = VK_DESCRIPTOR_TYPE_SAMPLER;
+                    break;
+
+                case SPV_REFLECT_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+                    info.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                    info.byte_size = b->block.size;
+                    break;
+
+                default:
+                    info.type = VK_DESCRIPTOR_TYPE_MAX_ENUM;
+                    break;
+            }
+
+            result.descriptors.emplace_back(std::move(info));
+        }
+
+        uint32_t pc_blocks = 0;
+        spvReflectEnumeratePushConstantBlocks(&refl_mod, &pc_blocks, nullptr);
+        std::vector<SpvReflectBlockVariable*> pcs(pc_blocks);
+        spvReflectEnumeratePushConstantBlocks(&refl_mod, &pc_blocks, pcs.data());
+
+        result.push_constants.reserve(pc_blocks);
+        for (const auto* pc : pcs)
+        {
+            VkPushConstantRange range{
+                .stageFlags = static_cast<VkShaderStageFlags>(result.stage),
+                .offset = pc->offset,
+                .size = pc->size
+            };
+            result.push_constants.emplace_back(range);
+        }
+
+        if (result.stage == ShaderType::Vertex)
+        {
+            uint32_t var_cnt = 0;
+            spvReflectEnumerateInputVariables(&refl_mod, &var_cnt, nullptr);
+            std::vector<SpvReflectInterfaceVariable*> vars(var_cnt);
+            spvReflectEnumerateInputVariables(&refl_mod, &var_cnt, vars.data());
+
+            std::ranges::sort(vars, {}, [](auto* v){ return v->location; });
+
+            uint32_t current_offset = 0;
+            result.binding.binding   = 0;
+            result.binding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+            result.attributes.reserve(var_cnt);
+            for (auto* v : vars)
+            {
+                const uint32_t size_in_bytes = (v->numeric.scalar.width >> 3) * v->numeric.vector.component_count;
+
+                result.attributes.emplace_back(
+                    v->location,
+                    0,
+                    static_cast<VkFormat>(v->format),
+                    current_offset
+                );
+
+                current_offset += size_in_bytes;
+            }
+            result.binding.stride = current_offset;
+        }
+
+
+        spvReflectDestroyShaderModule(&refl_mod);
+        return result;
+    }
 }
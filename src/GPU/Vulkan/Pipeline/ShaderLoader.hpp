@@ -32,6 +32,19 @@ namespace boza
         uint32_t offset   = 0;
     };
 
+    using keyword_mask_t = uint64_t;
+
+    // A shader file with some of its keywords switched on. Shaders declare keywords with `#pragma keywords A B ...`;
+    // bit i of keywords enables the i-th declared name, which is then defined as 1 instead of 0.
+    struct ShaderVariant
+    {
+        ShaderVariant(std::string path, const keyword_mask_t keywords = 0) : path{ std::move(path) }, keywords{ keywords } {}
+        ShaderVariant(const char* path, const keyword_mask_t keywords = 0) : path{ path }, keywords{ keywords } {}
+
+        std::string    path;
+        keyword_mask_t keywords{ 0 };
+    };
+
     struct ShaderReflectionInfo
     {
         VkShaderModule module = nullptr;
@@ -48,17 +61,31 @@ namespace boza
     class ShaderLoader final
     {
     public:
+        // Serves SPIR-V and reflection from the ShaderCache when the preprocessed source, stage, compile options and
+        // tool versions all match a previous build; otherwise compiles, validates, optimises and stores the result.
+        [[nodiscard]]
+        static std::optional<ShaderReflectionInfo> load_shader(const ShaderVariant& variant);
+
+        // Mask enabling the named keywords of the shader at path; nullopt if it does not declare one of them.
         [[nodiscard]]
-        static std::optional<ShaderReflectionInfo> load_shader(const std::string_view& path);
+        static std::optional<keyword_mask_t> make_keyword_mask(const std::string_view& path, std::span<const std::string> names);
 
         static void destroy_shader_module(const VkShaderModule& shader_module);
 
     private:
-        static std::string           read_source(const fs::path& file_path);
-        static std::vector<uint32_t> compile_to_spirv(const fs::path& file_path, const std::string& source);
-        static bool                  validate_spirv(const std::vector<uint32_t>& spirv, const fs::path& file_path);
-        static std::vector<uint32_t> optimise_spirv(const std::vector<uint32_t>& spirv, const fs::path& file_path);
-        static shaderc_shader_kind   deduce_shader_kind(const fs::path& path);
-        static ShaderType            deduce_shader_stage(const fs::path& path);
+        // "..." includes resolve next to the including file, <...> includes under this directory.
+        static constexpr const char include_directory[] = "shaders";
+
+        static std::string              read_source(const fs::path& file_path);
+        static std::vector<std::string> parse_keywords(const std::string& source);
+        static shaderc::CompileOptions  make_compile_options(const std::vector<std::string>& keywords, keyword_mask_t enabled);
+        static std::string              preprocess(const fs::path& file_path, const std::string& source, const shaderc::CompileOptions& options);
+        static uint64_t                 make_cache_key(const fs::path& file_path, const std::string& preprocessed);
+        static std::vector<uint32_t>    compile_to_spirv(const fs::path& file_path, const std::string& source, const shaderc::CompileOptions& options);
+        static bool                     validate_spirv(const std::vector<uint32_t>& spirv, const fs::path& file_path);
+        static std::vector<uint32_t>    optimise_spirv(const std::vector<uint32_t>& spirv, const fs::path& file_path);
+        static std::optional<ShaderReflectionInfo> reflect(const std::vector<uint32_t>& spirv, const fs::path& file_path);
+        static shaderc_shader_kind      deduce_shader_kind(const fs::path& path);
+        static ShaderType               deduce_shader_stage(const fs::path& path);
     };
 }
@@ -30,45 +30,67 @@ namespace boza
     DEFINE_FORMAT_GROUP(u, 32, UINT);
     DEFINE_FORMAT_GROUP(u, 64, UINT);
 
+    // glm matrices occupy one attribute location per column
+    template<typename T>
+    struct attribute_columns
+    {
+        static constexpr uint32_t value = 1;
+        using column_type = T;
+    };
+
+    template<glm::length_t C, glm::length_t R, typename T, glm::qualifier Q>
+    struct attribute_columns<glm::mat<C, R, T, Q>>
+    {
+        static constexpr uint32_t value = C;
+        using column_type = glm::vec<R, T, Q>;
+    };
+
     struct VertexLayout
     {
-        VkVertexInputBindingDescription                binding;
+        std::vector<VkVertexInputBindingDescription>   bindings;
         std::vector<VkVertexInputAttributeDescription> attributes;
     };
 
+    // Appends VertexT as a new binding; its attributes take the locations following the existing ones.
     template<typename VertexT, std::size_t... I>
-    VertexLayout make_layout_from_pfr(std::index_sequence<I...>)
+    bool append_layout_from_pfr(VertexLayout& layout, const VkVertexInputRate input_rate, std::index_sequence<I...>)
     {
-        VertexLayout layout;
+        const auto binding = static_cast<uint32_t>(layout.bindings.size());
 
-        layout.binding.binding   = 0;
-        layout.binding.stride    = static_cast<uint32_t>(sizeof(VertexT));
-        layout.binding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+        layout.bindings.push_back({
+            .binding   = binding,
+            .stride    = static_cast<uint32_t>(sizeof(VertexT)),
+            .inputRate = input_rate
+        });
 
-        uint32_t next_location = 0;
-        VertexT  dummy{};
+        auto    next_location = static_cast<uint32_t>(layout.attributes.size());
+        VertexT dummy{};
 
         bool error = false;
 
         (..., ([&]
         {
             if (error) return;
-            using FieldT = std::remove_cvref_t<decltype(boost::pfr::get<I>(std::declval<VertexT>()))>;
+            using FieldT  = std::remove_cvref_t<decltype(boost::pfr::get<I>(std::declval<VertexT>()))>;
+            using ColumnT = typename attribute_columns<FieldT>::column_type;
 
             if constexpr (!std::is_same_v<FieldT, bool>)
             {
-                if constexpr (requires { format_of<FieldT>::value; })
+                if constexpr (requires { format_of<ColumnT>::value; })
                 {
                     const uint32_t offset =
                         reinterpret_cast<const char*>(&boost::pfr::get<I>(dummy)) -
                         reinterpret_cast<const char*>(&dummy);
 
-                    layout.attributes.emplace_back(
-                        next_location++,
-                        0,
-                        format_of<FieldT>::value,
-                        offset
-                    );
+                    for (uint32_t column = 0; column < attribute_columns<FieldT>::value; ++column)
+                    {
+                        layout.attributes.emplace_back(
+                            next_location++,
+                            binding,
+                            format_of<ColumnT>::value,
+                            offset + column * static_cast<uint32_t>(sizeof(ColumnT))
+                        );
+                    }
                 }
                 else
                 {
@@ -78,12 +100,11 @@ namespace boza
                         boost::pfr::get_name<I, VertexT>());
 
                     error = true;
-                    layout.attributes.clear();
                 }
             }
         }()));
 
-        return layout;
+        return !error;
     }
 
 
@@ -92,6 +113,26 @@ namespace boza
     {
         constexpr std::size_t N = boost::pfr::tuple_size_v<VertexT>;
         static_assert(N > 0, "Vertex type must have at least one field.");
-        return make_layout_from_pfr<VertexT>(std::make_index_sequence<N>{});
+
+        VertexLayout layout;
+        if (!append_layout_from_pfr<VertexT>(layout, VK_VERTEX_INPUT_RATE_VERTEX, std::make_index_sequence<N>{}))
+            return {};
+
+        return layout;
+    }
+
+    // Binding 0 advances per vertex, binding 1 per instance.
+    template<typename VertexT, typename InstanceT>
+    VertexLayout get_layout()
+    {
+        constexpr std::size_t N = boost::pfr::tuple_size_v<InstanceT>;
+        static_assert(N > 0, "Instance type must have at least one field.");
+
+        VertexLayout layout = get_layout<VertexT>();
+        if (layout.bindings.empty() ||
+            !append_layout_from_pfr<InstanceT>(layout, VK_VERTEX_INPUT_RATE_INSTANCE, std::make_index_sequence<N>{}))
+            return {};
+
+        return layout;
     }
 }
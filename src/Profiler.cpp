@@ -0,0 +1,216 @@
+#include "Profiler.hpp"
+#include "Logger.hpp"
+
+namespace boza
+{
+    namespace
+    {
+        void write_escaped(std::ostream& out, const std::string_view text)
+        {
+            for (const char c : text)
+            {
+                if (c == '"' || c == '\\') out << '\\' << c;
+                else if (static_cast<unsigned char>(c) < 0x20) out << ' ';
+                else out << c;
+            }
+        }
+
+        template<typename T>
+        void write_raw(std::ostream& out, const T& value)
+        {
+            out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+    }
+
+
+    void Profiler::counter(const std::string_view name, const double value)
+    {
+        const uint64_t time = now();
+        record({ name, time, time, value, EventKind::Counter });
+    }
+
+    void Profiler::frame()
+    {
+        const uint64_t time = now();
+        record({ "Frame", time, time, 0.0, EventKind::Frame });
+    }
+
+    void Profiler::record(const Event& event)
+    {
+        ThreadBuffer&  buffer  = instance().local_buffer();
+        const uint64_t written = buffer.written.load(std::memory_order_relaxed);
+        Slot&          slot    = buffer.slots[written % ring_capacity];
+
+        slot.sequence.store(2 * written + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot.name_data.store(event.name.data(), std::memory_order_relaxed);
+        slot.name_size.store(event.name.size(), std::memory_order_relaxed);
+        slot.start.store(event.start, std::memory_order_relaxed);
+        slot.end.store(event.end, std::memory_order_relaxed);
+        slot.value.store(event.value, std::memory_order_relaxed);
+        slot.kind.store(event.kind, std::memory_order_relaxed);
+
+        slot.sequence.store(2 * written + 2, std::memory_order_release);
+        buffer.written.store(written + 1, std::memory_order_release);
+    }
+
+    uint64_t Profiler::now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - instance().epoch).count();
+    }
+
+
+    bool Profiler::export_chrome_trace(const fs::path& path)
+    {
+        std::ofstream file{ path, std::ios::trunc };
+        if (!file)
+        {
+            Logger::error("Failed to open {} for writing", path.string());
+            return false;
+        }
+
+        file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+        bool first = true;
+        for (const auto& [thread_index, events] : instance().snapshot())
+        {
+            for (const auto& [name, start, end, value, kind] : events)
+            {
+                file << (first ? "\n" : ",\n") << "{\"name\":\"";
+                write_escaped(file, name);
+                file << "\",\"pid\":0,\"tid\":" << thread_index << ",\"ts\":" << static_cast<double>(start) / 1000.0;
+
+                switch (kind)
+                {
+                    case EventKind::Zone:
+                        file << ",\"ph\":\"X\",\"dur\":" << static_cast<double>(end - start) / 1000.0 << '}';
+                        break;
+                    case EventKind::Counter:
+                        file << ",\"ph\":\"C\",\"args\":{\"value\":" << value << "}}";
+                        break;
+                    case EventKind::Frame:
+                        file << ",\"ph\":\"i\",\"s\":\"g\"}";
+                        break;
+                }
+
+                first = false;
+            }
+        }
+
+        file << "\n]}\n";
+        return static_cast<bool>(file);
+    }
+
+    bool Profiler::export_binary(const fs::path& path)
+    {
+        std::ofstream file{ path, std::ios::binary | std::ios::trunc };
+        if (!file)
+        {
+            Logger::error("Failed to open {} for writing", path.string());
+            return false;
+        }
+
+        const auto threads = instance().snapshot();
+
+        std::vector<std::string_view>                  names;
+        std::unordered_map<std::string_view, uint32_t> name_indices;
+        uint64_t                                       event_count = 0;
+
+        for (const auto& [thread_index, events] : threads)
+        {
+            event_count += events.size();
+            for (const auto& event : events)
+            {
+                if (name_indices.try_emplace(event.name, static_cast<uint32_t>(names.size())).second)
+                    names.push_back(event.name);
+            }
+        }
+
+        file.write("BZPF", 4);
+        write_raw(file, binary_version);
+
+        write_raw(file, static_cast<uint32_t>(names.size()));
+        for (const auto& name : names)
+        {
+            write_raw(file, static_cast<uint32_t>(name.size()));
+            file.write(name.data(), static_cast<std::streamsize>(name.size()));
+        }
+
+        write_raw(file, event_count);
+        for (const auto& [thread_index, events] : threads)
+        {
+            for (const auto& [name, start, end, value, kind] : events)
+            {
+                write_raw(file, static_cast<uint8_t>(kind));
+                write_raw(file, thread_index);
+                write_raw(file, name_indices.at(name));
+                write_raw(file, start);
+                write_raw(file, end);
+                write_raw(file, value);
+            }
+        }
+
+        return static_cast<bool>(file);
+    }
+
+
+    Profiler::ThreadBuffer& Profiler::local_buffer()
+    {
+        thread_local ThreadBuffer* buffer = nullptr;
+        if (buffer != nullptr) return *buffer;
+
+        std::lock_guard lock{ mutex };
+
+        auto owned          = std::make_unique<ThreadBuffer>();
+        owned->thread_index = static_cast<uint32_t>(buffers.size());
+        buffer              = owned.get();
+        buffers.push_back(std::move(owned));
+
+        return *buffer;
+    }
+
+    std::vector<Profiler::Snapshot> Profiler::snapshot()
+    {
+        std::lock_guard lock{ mutex };
+
+        std::vector<Snapshot> snapshots;
+        snapshots.reserve(buffers.size());
+
+        for (const auto& buffer : buffers)
+        {
+            Snapshot& snapshot = snapshots.emplace_back(Snapshot{ buffer->thread_index, {} });
+
+            // the owner keeps writing while we copy; each slot's sequence tells whether it still holds event i
+            const uint64_t end   = buffer->written.load(std::memory_order_acquire);
+            const uint64_t begin = end > ring_capacity ? end - ring_capacity : 0;
+            snapshot.events.reserve(end - begin);
+
+            for (uint64_t i = begin; i < end; ++i)
+            {
+                const Slot&    slot     = buffer->slots[i % ring_capacity];
+                const uint64_t expected = 2 * i + 2;
+
+                if (slot.sequence.load(std::memory_order_acquire) != expected) continue;
+
+                const Event event
+                {
+                    { slot.name_data.load(std::memory_order_relaxed), slot.name_size.load(std::memory_order_relaxed) },
+                    slot.start.load(std::memory_order_relaxed),
+                    slot.end.load(std::memory_order_relaxed),
+                    slot.value.load(std::memory_order_relaxed),
+                    slot.kind.load(std::memory_order_relaxed)
+                };
+
+                // overwritten or still being written since we checked
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.sequence.load(std::memory_order_relaxed) != expected) continue;
+
+                snapshot.events.push_back(event);
+            }
+        }
+
+        return snapshots;
+    }
+}
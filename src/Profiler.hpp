@@ -0,0 +1,116 @@
+#pragma once
+#include "boza_pch.hpp"
+#include "Singleton.hpp"
+
+namespace boza
+{
+    // Zones and counters are recorded into per-thread ring buffers; only the newest ring_capacity events per thread survive.
+    // Instrumentation goes through the BOZA_PROFILE_* macros, which expand to nothing unless BOZA_PROFILER is defined.
+    class BOZA_API Profiler final : public Singleton<Profiler>
+    {
+    public:
+        enum class EventKind : uint8_t
+        {
+            Zone,
+            Counter,
+            Frame
+        };
+
+        struct Event
+        {
+            std::string_view name;
+            uint64_t         start;
+            uint64_t         end;
+            double           value;
+            EventKind        kind;
+        };
+
+        class Zone final
+        {
+        public:
+            explicit Zone(const std::string_view name) : name{ name }, start{ now() } {}
+            ~Zone() { record({ name, start, now(), 0.0, EventKind::Zone }); }
+
+            Zone(const Zone&)            = delete;
+            Zone(Zone&&)                 = delete;
+            Zone& operator=(const Zone&) = delete;
+            Zone& operator=(Zone&&)      = delete;
+
+        private:
+            std::string_view name;
+            uint64_t         start;
+        };
+
+        static void counter(std::string_view name, double value);
+        static void frame();
+
+        // Names must outlive the profiler; string literals and entt::type_name values do.
+        static void record(const Event& event);
+
+        // Nanoseconds since the profiler was first used.
+        [[nodiscard]] static uint64_t now();
+
+        static bool export_chrome_trace(const fs::path& path);
+        // "BZPF", version, name table, then fixed-size event records.
+        static bool export_binary(const fs::path& path);
+
+    private:
+        static constexpr size_t   ring_capacity  = 1 << 15;
+        static constexpr uint32_t binary_version = 1;
+
+        // Per-slot seqlock: sequence is 2 * n + 1 while event n is being written and 2 * n + 2 once it is complete,
+        // so a reader can tell a torn or already recycled slot from the one it asked for. Fields are relaxed
+        // atomics so the copy itself is not a data race.
+        struct Slot
+        {
+            std::atomic_uint64_t     sequence{ 0 };
+            std::atomic<const char*> name_data{ nullptr };
+            std::atomic_size_t       name_size{ 0 };
+            std::atomic_uint64_t     start{ 0 };
+            std::atomic_uint64_t     end{ 0 };
+            std::atomic<double>      value{ 0.0 };
+            std::atomic<EventKind>   kind{ EventKind::Zone };
+        };
+
+        struct ThreadBuffer
+        {
+            uint32_t                        thread_index;
+            std::array<Slot, ring_capacity> slots;
+            std::atomic_uint64_t            written{ 0 };
+        };
+
+        struct Snapshot
+        {
+            uint32_t           thread_index;
+            std::vector<Event> events;
+        };
+
+        [[nodiscard]] ThreadBuffer& local_buffer();
+        [[nodiscard]] std::vector<Snapshot> snapshot();
+
+        const std::chrono::steady_clock::time_point epoch{ std::chrono::steady_clock::now() };
+
+        std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+        std::mutex                                 mutex;
+
+        friend Singleton;
+        Profiler() = default;
+    };
+}
+
+#define BOZA_PROFILE_CONCAT_IMPL(A, B) A##B
+#define BOZA_PROFILE_CONCAT(A, B) BOZA_PROFILE_CONCAT_IMPL(A, B)
+
+#ifdef BOZA_PROFILER
+    #define BOZA_PROFILE_ZONE(NAME) const ::boza::Profiler::Zone BOZA_PROFILE_CONCAT(profile_zone_, __LINE__){ NAME }
+    #define BOZA_PROFILE_FUNCTION() BOZA_PROFILE_ZONE(__func__)
+    #define BOZA_PROFILE_COUNTER(NAME, VALUE) ::boza::Profiler::counter(NAME, static_cast<double>(VALUE))
+    #define BOZA_PROFILE_FRAME() ::boza::Profiler::frame()
+    #define BOZA_PROFILE_ONLY(...) __VA_ARGS__
+#else
+    #define BOZA_PROFILE_ZONE(NAME) ((void)0)
+    #define BOZA_PROFILE_FUNCTION() ((void)0)
+    #define BOZA_PROFILE_COUNTER(NAME, VALUE) ((void)0)
+    #define BOZA_PROFILE_FRAME() ((void)0)
+    #define BOZA_PROFILE_ONLY(...)
+#endif
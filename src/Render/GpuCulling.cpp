@@ -0,0 +1,293 @@
+#include "GpuCulling.hpp"
+
+#include "GPU/Vulkan/Core/Device.hpp"
+#include "Logger.hpp"
+#include "Profiler.hpp"
+
+namespace boza
+{
+    namespace
+    {
+        static_assert(sizeof(GpuCulling::Object) == 112, "GpuCulling::Object must match DrawObject in shaders/cull.comp");
+
+        // Gribb-Hartmann planes for a [0, 1] depth range, normalised so distances are in world units.
+        std::array<glm::vec4, 6> extract_frustum_planes(const glm::mat4& m)
+        {
+            const glm::vec4 row0{ m[0][0], m[1][0], m[2][0], m[3][0] };
+            const glm::vec4 row1{ m[0][1], m[1][1], m[2][1], m[3][1] };
+            const glm::vec4 row2{ m[0][2], m[1][2], m[2][2], m[3][2] };
+            const glm::vec4 row3{ m[0][3], m[1][3], m[2][3], m[3][3] };
+
+            std::array planes{ row3 + row0, row3 - row0, row3 + row1, row3 - row1, row2, row3 - row2 };
+            for (auto& plane : planes)
+                plane /= glm::length(glm::vec3{ plane });
+
+            return planes;
+        }
+
+        void memory_barrier(
+            const VkCommandBuffer       command_buffer,
+            const VkPipelineStageFlags2 src_stage,
+            const VkAccessFlags2        src_access,
+            const VkPipelineStageFlags2 dst_stage,
+            const VkAccessFlags2        dst_access)
+        {
+            const VkMemoryBarrier2 barrier
+            {
+                .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+                .pNext = nullptr,
+                .srcStageMask = src_stage,
+                .srcAccessMask = src_access,
+                .dstStageMask = dst_stage,
+                .dstAccessMask = dst_access
+            };
+
+            const VkDependencyInfo dependency_info
+            {
+                .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+                .pNext = nullptr,
+                .dependencyFlags = 0,
+                .memoryBarrierCount = 1,
+                .pMemoryBarriers = &barrier,
+                .bufferMemoryBarrierCount = 0,
+                .pBufferMemoryBarriers = nullptr,
+                .imageMemoryBarrierCount = 0,
+                .pImageMemoryBarriers = nullptr
+            };
+
+            vkCmdPipelineBarrier2(command_buffer, &dependency_info);
+        }
+    }
+
+    bool GpuCulling::create()
+    {
+        auto& inst = instance();
+
+        inst.supported = Device::supports_indirect_count();
+        if (!inst.supported)
+        {
+            Logger::warn("Device cannot draw with an indirect count, culling stays on the CPU");
+            return true;
+        }
+
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(Device::get_physical_device(), &properties);
+        inst.max_draw_count = properties.limits.maxDrawIndirectCount;
+
+        std::array<VkDescriptorSetLayoutBinding, binding_count> bindings{};
+        for (uint32_t i = 0; i < binding_count; ++i)
+        {
+            bindings[i] =
+            {
+                .binding = i,
+                .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                .descriptorCount = 1,
+                .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                .pImmutableSamplers = nullptr
+            };
+        }
+
+        const VkDescriptorSetLayoutCreateInfo layout_info
+        {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .bindingCount = static_cast<uint32_t>(bindings.size()),
+            .pBindings = bindings.data()
+        };
+
+        VK_CHECK(vkCreateDescriptorSetLayout(Device::get_device(), &layout_info, nullptr, &inst.set_layout),
+        {
+            LOG_VK_ERROR("Failed to create culling descriptor set layout");
+            return false;
+        });
+
+        inst.pipeline = PipelineManager::create_compute_pipeline("shaders/cull.comp");
+        return inst.pipeline != INVALID_PIPELINE_ID;
+    }
+
+    void GpuCulling::destroy()
+    {
+        auto& inst = instance();
+
+        for (auto& frame : inst.frames)
+        {
+            frame.objects.destroy();
+            frame.commands.destroy();
+            frame.instances.destroy();
+            frame.counts.destroy();
+            frame = {};
+        }
+
+        if (inst.set_layout != nullptr)
+        {
+            vkDestroyDescriptorSetLayout(Device::get_device(), inst.set_layout, nullptr);
+            inst.set_layout = nullptr;
+        }
+
+        if (inst.pipeline != INVALID_PIPELINE_ID)
+        {
+            PipelineManager::destroy_pipeline(inst.pipeline);
+            inst.pipeline = INVALID_PIPELINE_ID;
+        }
+
+        inst.supported = false;
+    }
+
+
+    bool     GpuCulling::is_supported() { return instance().supported; }
+    uint32_t GpuCulling::get_max_draw_count() { return instance().max_draw_count; }
+
+
+    bool GpuCulling::upload(const std::span<const Object> objects, const uint32_t batch_count)
+    {
+        auto&         inst  = instance();
+        FrameBuffers& frame = inst.frames[Swapchain::current_frame_idx()];
+
+        frame.object_count = 0;
+        frame.batch_count  = 0;
+        if (objects.empty()) return true;
+
+        const auto object_count = static_cast<uint32_t>(objects.size());
+        if (!inst.reserve(frame, object_count, batch_count)) return false;
+
+        memcpy(frame.objects.get_mapped_data(), objects.data(), objects.size_bytes());
+        frame.object_count = object_count;
+        frame.batch_count  = batch_count;
+        return true;
+    }
+
+    bool GpuCulling::record_cull(const VkCommandBuffer command_buffer, const glm::mat4& view_projection)
+    {
+        BOZA_PROFILE_FUNCTION();
+
+        auto&               inst  = instance();
+        const FrameBuffers& frame = inst.frames[Swapchain::current_frame_idx()];
+        if (frame.object_count == 0) return true;
+
+        const auto buffer_write = [](const Binding binding, const Buffer& buffer)
+        {
+            return DescriptorWrite{
+                .binding = binding,
+                .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                .buffer = { .buffer = buffer.get_buffer(), .offset = 0, .range = VK_WHOLE_SIZE }
+            };
+        };
+
+        const std::array<DescriptorWrite, binding_count> writes
+        {
+            buffer_write(objects_binding, frame.objects),
+            buffer_write(commands_binding, frame.commands),
+            buffer_write(counts_binding, frame.counts),
+            buffer_write(instances_binding, frame.instances)
+        };
+
+        // reset with the frame, so buffers regrown by reserve need no rewrite of an older set
+        const VkDescriptorSet descriptor_set = DescriptorPool::get_set(inst.set_layout, writes, DescriptorLifetime::Frame);
+        if (descriptor_set == nullptr)
+        {
+            Logger::error("Failed to get culling descriptor set");
+            return false;
+        }
+
+        vkCmdFillBuffer(command_buffer, frame.counts.get_buffer(), 0, frame.batch_count * sizeof(uint32_t), 0);
+        memory_barrier(command_buffer,
+            VK_PIPELINE_STAGE_2_CLEAR_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+            VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+
+        const CullConstants constants
+        {
+            .planes = extract_frustum_planes(view_projection),
+            .object_count = frame.object_count
+        };
+
+        const VkPipelineLayout layout = PipelineManager::get_pipeline(inst.pipeline).get_layout();
+
+        PipelineManager::bind_pipeline(command_buffer, inst.pipeline);
+        vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, layout, 0, 1, &descriptor_set, 0, nullptr);
+        // the aligned vec4s pad the struct past the shader's block, so only the block itself is pushed
+        constexpr uint32_t constants_size = offsetof(CullConstants, object_count) + sizeof(uint32_t);
+        vkCmdPushConstants(command_buffer, layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, constants_size, &constants);
+        vkCmdDispatch(command_buffer, (frame.object_count + workgroup_size - 1) / workgroup_size, 1, 1);
+
+        memory_barrier(command_buffer,
+            VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+            VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT,
+            VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT);
+
+        return true;
+    }
+
+    void GpuCulling::bind_instances(const VkCommandBuffer command_buffer)
+    {
+        constexpr VkDeviceSize offset = 0;
+        const VkBuffer         buffer = instance().frames[Swapchain::current_frame_idx()].instances.get_buffer();
+        if (buffer != nullptr) vkCmdBindVertexBuffers(command_buffer, 1, 1, &buffer, &offset);
+    }
+
+    void GpuCulling::draw_batch(
+        const VkCommandBuffer command_buffer,
+        const uint32_t        batch,
+        const uint32_t        first_command,
+        const uint32_t        max_count)
+    {
+        const FrameBuffers& frame = instance().frames[Swapchain::current_frame_idx()];
+
+        vkCmdDrawIndexedIndirectCount(
+            command_buffer,
+            frame.commands.get_buffer(), first_command * sizeof(VkDrawIndexedIndirectCommand),
+            frame.counts.get_buffer(), batch * sizeof(uint32_t),
+            max_count, sizeof(VkDrawIndexedIndirectCommand));
+    }
+
+
+    bool GpuCulling::reserve(FrameBuffers& frame, const uint32_t object_count, const uint32_t batch_count)
+    {
+        // only this frame's buffers are replaced, and its fence has already signalled
+        if (object_count > frame.object_capacity)
+        {
+            const uint32_t capacity = std::max({ object_count, frame.object_capacity * 2, 1024u });
+
+            frame.objects.destroy();
+            frame.commands.destroy();
+            frame.instances.destroy();
+            frame.object_capacity = 0;
+
+            frame.objects   = Buffer::create(capacity * sizeof(Object), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
+            frame.commands  = Buffer::create(capacity * sizeof(VkDrawIndexedIndirectCommand),
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+            frame.instances = Buffer::create(capacity * sizeof(glm::mat4),
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+
+            if (frame.objects.get_buffer() == nullptr || frame.commands.get_buffer() == nullptr || frame.instances.get_buffer() == nullptr)
+            {
+                Logger::error("Failed to grow culling buffers to {} objects", capacity);
+                return false;
+            }
+
+            frame.object_capacity = capacity;
+        }
+
+        if (batch_count > frame.batch_capacity)
+        {
+            const uint32_t capacity = std::max({ batch_count, frame.batch_capacity * 2, 64u });
+
+            frame.counts.destroy();
+            frame.batch_capacity = 0;
+
+            frame.counts = Buffer::create(capacity * sizeof(uint32_t),
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VMA_MEMORY_USAGE_GPU_ONLY);
+
+            if (frame.counts.get_buffer() == nullptr)
+            {
+                Logger::error("Failed to grow culling count buffer to {} batches", capacity);
+                return false;
+            }
+
+            frame.batch_capacity = capacity;
+        }
+
+        return true;
+    }
+}
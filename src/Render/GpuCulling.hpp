@@ -0,0 +1,92 @@
+#pragma once
+#include "boza_pch.hpp"
+#include "Singleton.hpp"
+#include "GPU/Vulkan/Core/Swapchain.hpp"
+#include "GPU/Vulkan/Descriptor/DescriptorPool.hpp"
+#include "GPU/Vulkan/Memory/Buffer.hpp"
+#include "GPU/Vulkan/Pipeline/PipelineManager.hpp"
+
+namespace boza
+{
+    // Frustum culling and draw generation on the GPU. The caller groups objects into batches that each own a
+    // contiguous range of indirect commands; shaders/cull.comp appends one command per visible object to its
+    // batch's range, bumps the batch's count and writes the object's transform to the instance at that index.
+    class GpuCulling final : public Singleton<GpuCulling>
+    {
+    public:
+        // std430 mirror of DrawObject in shaders/cull.comp
+        struct Object
+        {
+            glm::mat4 model;
+            // local-space bounding sphere, as Mesh::bounds
+            glm::vec4 bounds;
+            uint32_t  index_count;
+            uint32_t  first_index;
+            int32_t   vertex_offset;
+            uint32_t  first_command;
+            uint32_t  batch;
+            uint32_t  padding[3];
+        };
+
+        // Succeeds without doing anything when the device cannot draw with an indirect count.
+        [[nodiscard]] static bool create();
+        static void destroy();
+
+        [[nodiscard]] static bool     is_supported();
+        [[nodiscard]] static uint32_t get_max_draw_count();
+
+        // Copies the frame's objects into the current frame's buffers, growing them when needed.
+        [[nodiscard]] static bool upload(std::span<const Object> objects, uint32_t batch_count);
+
+        // Must be recorded outside of rendering and before any draw_batch of the same frame.
+        [[nodiscard]] static bool record_cull(VkCommandBuffer command_buffer, const glm::mat4& view_projection);
+
+        // Binds the surviving transforms to binding 1, laid out like Renderer::InstanceData.
+        static void bind_instances(VkCommandBuffer command_buffer);
+        static void draw_batch(VkCommandBuffer command_buffer, uint32_t batch, uint32_t first_command, uint32_t max_count);
+
+    private:
+        static constexpr uint32_t workgroup_size = 64;
+
+        struct CullConstants
+        {
+            std::array<glm::vec4, 6> planes;
+            uint32_t                 object_count;
+        };
+
+        struct FrameBuffers
+        {
+            Buffer   objects{};
+            Buffer   commands{};
+            Buffer   instances{};
+            Buffer   counts{};
+            uint32_t object_capacity{ 0 };
+            uint32_t batch_capacity{ 0 };
+            uint32_t object_count{ 0 };
+            uint32_t batch_count{ 0 };
+        };
+
+        [[nodiscard]] bool reserve(FrameBuffers& frame, uint32_t object_count, uint32_t batch_count);
+
+        std::array<FrameBuffers, Swapchain::max_frames_in_flight> frames{};
+
+        // bindings in shaders/cull.comp order; the set itself is taken from the frame's descriptor pools
+        enum Binding : uint32_t
+        {
+            objects_binding,
+            commands_binding,
+            counts_binding,
+            instances_binding,
+            binding_count
+        };
+
+        VkDescriptorSetLayout set_layout{ nullptr };
+
+        pipeline_id_t pipeline{ INVALID_PIPELINE_ID };
+        uint32_t      max_draw_count{ 0 };
+        bool          supported{ false };
+
+        friend Singleton;
+        GpuCulling() = default;
+    };
+}
@@ -1,35 +1,25 @@
 #pragma once
 #include "boza_pch.hpp"
-#include "GPU/Vulkan/Memory/Buffer.hpp"
+#include "GPU/Vulkan/Memory/OffsetAllocator.hpp"
 
 namespace boza
 {
-    class Mesh final
+    // Geometry record inside MeshManager's shared vertex and index pools.
+    struct Mesh
     {
-    public:
-        ~Mesh();
-        Mesh(const Mesh&) = delete;
-        Mesh& operator=(const Mesh&) = delete;
-        Mesh(Mesh&& other) noexcept;
-        Mesh& operator=(Mesh&& other) noexcept;
+        uint32_t vertex_pool{ 0 };
+        uint32_t index_pool{ 0 };
 
-        void bind(VkCommandBuffer command_buffer) const;
-        void draw(VkCommandBuffer command_buffer) const;
+        OffsetAllocator::Allocation vertex_allocation{};
+        OffsetAllocator::Allocation index_allocation{};
 
-    private:
-        friend class MeshManager;
+        // in vertices and indices of the pools, as vkCmdDrawIndexed takes them
+        int32_t  vertex_offset{ 0 };
+        uint32_t first_index{ 0 };
+        uint32_t vertex_count{ 0 };
+        uint32_t index_count{ 0 };
 
-        Mesh() = default;
-        template<typename Vertex>
-        static Mesh create(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices);
-
-        Buffer vertex_buffer{};
-        Buffer index_buffer{};
-        uint32_t vertex_count;
-        uint32_t index_count;
+        // local-space bounding sphere (xyz center, w radius); infinite when the vertex type has no position
+        glm::vec4 bounds{ 0.0f, 0.0f, 0.0f, std::numeric_limits<float>::infinity() };
     };
-
-
 }
-
-#include "Mesh.inl"
@@ -1,18 +1,106 @@
 #include "MeshManager.hpp"
 
+#include "GPU/Vulkan/Core/Swapchain.hpp"
+#include "GPU/Vulkan/Memory/StagingRing.hpp"
+#include "Logger.hpp"
+
 namespace boza
 {
-    void MeshManager::cleanup() { instance().meshes.clear(); }
+    void MeshManager::cleanup()
+    {
+        auto& inst = instance();
+
+        for (auto& pool : inst.vertex_pools)
+            pool.buffer.destroy();
+        for (auto& pool : inst.index_pools)
+            pool.buffer.destroy();
+
+        inst.vertex_pools.clear();
+        inst.index_pools.clear();
+        inst.retired.clear();
+        inst.meshes.clear();
+    }
+
+    void MeshManager::begin_frame()
+    {
+        auto& inst = instance();
+
+        std::erase_if(inst.retired, [&inst](RetiredMesh& retired)
+        {
+            if (--retired.frames_left != 0) return false;
+
+            inst.release(retired.mesh);
+            return true;
+        });
+    }
+
+
+    mesh_id_t MeshManager::add_mesh(
+        const void*                  vertices,
+        const uint32_t               vertex_count,
+        const uint32_t               vertex_stride,
+        const std::vector<uint32_t>& indices,
+        const glm::vec4&             bounds)
+    {
+        if (vertex_count == 0 || indices.empty())
+        {
+            Logger::critical("Failed to create mesh: vertices or indices are empty");
+            return INVALID_MESH_ID;
+        }
+
+        const auto index_count = static_cast<uint32_t>(indices.size());
+
+        const auto vertex_allocation = allocate(vertex_pools, vertex_count, vertex_stride, vertex_pool_size, false);
+        if (!vertex_allocation) return INVALID_MESH_ID;
+
+        const auto index_allocation = allocate(index_pools, index_count, sizeof(uint32_t), index_pool_size, true);
+        if (!index_allocation)
+        {
+            vertex_pools[vertex_allocation->pool].allocator.free(vertex_allocation->allocation);
+            return INVALID_MESH_ID;
+        }
+
+        const Mesh mesh
+        {
+            .vertex_pool = vertex_allocation->pool,
+            .index_pool = index_allocation->pool,
+            .vertex_allocation = vertex_allocation->allocation,
+            .index_allocation = index_allocation->allocation,
+            .vertex_offset = static_cast<int32_t>(vertex_allocation->allocation.offset),
+            .first_index = index_allocation->allocation.offset,
+            .vertex_count = vertex_count,
+            .index_count = index_count,
+            .bounds = bounds
+        };
+
+        const VkDeviceSize vertex_offset = static_cast<VkDeviceSize>(mesh.vertex_offset) * vertex_stride;
+        const VkDeviceSize index_offset  = static_cast<VkDeviceSize>(mesh.first_index) * sizeof(uint32_t);
+
+        if (!StagingRing::upload(vertex_pools[mesh.vertex_pool].buffer.get_buffer(), vertices,
+                static_cast<VkDeviceSize>(vertex_count) * vertex_stride, vertex_offset) ||
+            !StagingRing::upload(index_pools[mesh.index_pool].buffer.get_buffer(), indices.data(),
+                static_cast<VkDeviceSize>(index_count) * sizeof(uint32_t), index_offset))
+        {
+            Logger::critical("Failed to upload mesh data");
+            release(mesh);
+            return INVALID_MESH_ID;
+        }
+
+        meshes.emplace(next_id, mesh);
+        return next_id++;
+    }
 
     void MeshManager::destroy_mesh(const mesh_id_t mesh_id)
     {
         assert(mesh_id != INVALID_MESH_ID && "Invalid mesh id");
         auto& inst = instance();
         assert(inst.meshes.contains(mesh_id));
+
+        inst.retired.push_back({ inst.meshes.at(mesh_id), Swapchain::max_frames_in_flight });
         inst.meshes.erase(mesh_id);
     }
 
-    Mesh& MeshManager::get_mesh(const mesh_id_t mesh_id)
+    const Mesh& MeshManager::get_mesh(const mesh_id_t mesh_id)
     {
         assert(mesh_id != INVALID_MESH_ID && "Invalid mesh id");
         auto& inst = instance();
@@ -20,6 +108,77 @@ namespace boza
         return inst.meshes.at(mesh_id);
     }
 
-    void MeshManager::bind(const VkCommandBuffer command_buffer, const mesh_id_t mesh_id) { get_mesh(mesh_id).bind(command_buffer); }
-    void MeshManager::draw(const VkCommandBuffer command_buffer, const mesh_id_t mesh_id) { get_mesh(mesh_id).draw(command_buffer); }
+
+    void MeshManager::bind(const VkCommandBuffer command_buffer, const mesh_id_t mesh_id, const mesh_id_t previous)
+    {
+        const auto& inst = instance();
+        const Mesh& mesh = get_mesh(mesh_id);
+        const Mesh* last = previous != INVALID_MESH_ID ? &get_mesh(previous) : nullptr;
+
+        if (last == nullptr || last->vertex_pool != mesh.vertex_pool)
+        {
+            constexpr VkDeviceSize offset = 0;
+            const VkBuffer         buffer = inst.vertex_pools[mesh.vertex_pool].buffer.get_buffer();
+            vkCmdBindVertexBuffers(command_buffer, 0, 1, &buffer, &offset);
+        }
+
+        if (last == nullptr || last->index_pool != mesh.index_pool)
+            vkCmdBindIndexBuffer(command_buffer, inst.index_pools[mesh.index_pool].buffer.get_buffer(), 0, VK_INDEX_TYPE_UINT32);
+    }
+
+    void MeshManager::draw(
+        const VkCommandBuffer command_buffer,
+        const mesh_id_t       mesh_id,
+        const uint32_t        instance_count,
+        const uint32_t        first_instance)
+    {
+        const Mesh& mesh = get_mesh(mesh_id);
+        vkCmdDrawIndexed(command_buffer, mesh.index_count, instance_count, mesh.first_index, mesh.vertex_offset, first_instance);
+    }
+
+
+    std::optional<MeshManager::PoolAllocation> MeshManager::allocate(
+        std::vector<GeometryPool>& pools,
+        const uint32_t             count,
+        const uint32_t             stride,
+        const VkDeviceSize         pool_size,
+        const bool                 index_pool)
+    {
+        for (uint32_t i = 0; i < pools.size(); ++i)
+        {
+            if (pools[i].stride != stride) continue;
+            if (const auto allocation = pools[i].allocator.allocate(count))
+                return PoolAllocation{ i, *allocation };
+        }
+
+        // every pool of this stride is full: open another, large enough for oversized meshes too. Free blocks are
+        // binned rounding down and requests rounding up, so the capacity is rounded to an exact bin size.
+        const auto         capacity = OffsetAllocator::round_up_size(static_cast<uint32_t>(std::max<VkDeviceSize>(pool_size / stride, count)));
+        const VkDeviceSize bytes    = static_cast<VkDeviceSize>(capacity) * stride;
+
+        Buffer buffer = index_pool ? Buffer::create_index_buffer(bytes) : Buffer::create_vertex_buffer(bytes);
+        if (buffer.get_buffer() == nullptr)
+        {
+            Logger::error("Failed to create {} pool of {} bytes", index_pool ? "index" : "vertex", bytes);
+            return std::nullopt;
+        }
+
+        Logger::trace("Created {} pool {} ({} bytes, stride {})", index_pool ? "index" : "vertex", pools.size(), bytes, stride);
+        pools.push_back({ std::move(buffer), OffsetAllocator{ capacity }, stride });
+
+        const auto allocation = pools.back().allocator.allocate(count);
+        if (!allocation.has_value())
+        {
+            Logger::error("Fresh {} pool of {} elements cannot hold {}", index_pool ? "index" : "vertex", capacity, count);
+            return std::nullopt;
+        }
+
+        return PoolAllocation{ static_cast<uint32_t>(pools.size() - 1), *allocation };
+    }
+
+    void MeshManager::release(const Mesh& mesh)
+    {
+        vertex_pools[mesh.vertex_pool].allocator.free(mesh.vertex_allocation);
+        index_pools[mesh.index_pool].allocator.free(mesh.index_allocation);
+    }
 }
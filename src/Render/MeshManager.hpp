@@ -2,29 +2,70 @@
 #include "boza_pch.hpp"
 #include "Singleton.hpp"
 #include "Mesh.hpp"
+#include "GPU/Vulkan/Memory/Buffer.hpp"
 
 namespace boza
 {
     using mesh_id_t = uint32_t;
     constexpr mesh_id_t INVALID_MESH_ID = std::numeric_limits<mesh_id_t>::max();
 
+    // All static geometry is sub-allocated from a few large vertex pools (one set per vertex stride)
+    // and shared index pools, so consecutive draws rarely need to rebind buffers.
     class MeshManager final : public Singleton<MeshManager>
     {
     public:
         static void cleanup();
 
+        // Ages meshes destroyed in earlier frames; call once the current frame's fence has signalled.
+        static void begin_frame();
+
         template<typename Vertex>
         static mesh_id_t create_mesh(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices);
+        // The geometry is released once the frames in flight that may still draw it have finished.
         static void destroy_mesh(mesh_id_t mesh_id);
-        static Mesh& get_mesh(mesh_id_t mesh_id);
+        static const Mesh& get_mesh(mesh_id_t mesh_id);
 
-        static void bind(VkCommandBuffer command_buffer, mesh_id_t mesh_id);
-        static void draw(VkCommandBuffer command_buffer, mesh_id_t mesh_id);
+        // Skips whichever bind the previous mesh drawn in the same command buffer already covers.
+        static void bind(VkCommandBuffer command_buffer, mesh_id_t mesh_id, mesh_id_t previous = INVALID_MESH_ID);
+        static void draw(VkCommandBuffer command_buffer, mesh_id_t mesh_id, uint32_t instance_count = 1, uint32_t first_instance = 0);
 
     private:
+        static constexpr VkDeviceSize vertex_pool_size = 64ull * 1024 * 1024;
+        static constexpr VkDeviceSize index_pool_size  = 32ull * 1024 * 1024;
+
+        struct GeometryPool
+        {
+            Buffer          buffer;
+            OffsetAllocator allocator;
+            uint32_t        stride;
+        };
+
+        struct PoolAllocation
+        {
+            uint32_t                    pool;
+            OffsetAllocator::Allocation allocation;
+        };
+
+        struct RetiredMesh
+        {
+            Mesh     mesh;
+            uint32_t frames_left;
+        };
+
+        [[nodiscard]] mesh_id_t add_mesh(
+            const void* vertices, uint32_t vertex_count, uint32_t vertex_stride, const std::vector<uint32_t>& indices, const glm::vec4& bounds);
+
+        [[nodiscard]] static std::optional<PoolAllocation> allocate(
+            std::vector<GeometryPool>& pools, uint32_t count, uint32_t stride, VkDeviceSize pool_size, bool index_pool);
+        void release(const Mesh& mesh);
+
         hash_map<mesh_id_t, Mesh> meshes;
         mesh_id_t                 next_id{ 0 };
 
+        std::vector<GeometryPool> vertex_pools;
+        std::vector<GeometryPool> index_pools;
+        std::vector<RetiredMesh>  retired;
+
         friend Singleton;
         MeshManager() = default;
     };
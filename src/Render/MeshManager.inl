@@ -6,10 +6,30 @@ namespace boza
     template<typename Vertex>
     mesh_id_t MeshManager::create_mesh(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices)
     {
-        auto& inst = instance();
-        Mesh  mesh = Mesh::create<Vertex>(vertices, indices);
-        if (mesh.vertex_count == 0 || mesh.index_count == 0) return INVALID_MESH_ID;
-        inst.meshes.emplace(inst.next_id, std::move(mesh));
-        return inst.next_id++;
+        glm::vec4 bounds{ 0.0f, 0.0f, 0.0f, std::numeric_limits<float>::infinity() };
+
+        if constexpr (requires(const Vertex& vertex) { glm::vec3{ vertex.position }; })
+        {
+            if (!vertices.empty())
+            {
+                glm::vec3 min{ vertices[0].position };
+                glm::vec3 max{ min };
+                for (const auto& vertex : vertices)
+                {
+                    min = glm::min(min, glm::vec3{ vertex.position });
+                    max = glm::max(max, glm::vec3{ vertex.position });
+                }
+
+                const glm::vec3 center = (min + max) * 0.5f;
+
+                float radius = 0.0f;
+                for (const auto& vertex : vertices)
+                    radius = std::max(radius, glm::distance(center, glm::vec3{ vertex.position }));
+
+                bounds = glm::vec4{ center, radius };
+            }
+        }
+
+        return instance().add_mesh(vertices.data(), static_cast<uint32_t>(vertices.size()), sizeof(Vertex), indices, bounds);
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,101 @@
+#include "RadixSort.hpp"
+
+#include "Core/JobSystem/JobSystem.hpp"
+#include "Profiler.hpp"
+
+namespace boza
+{
+    namespace
+    {
+        constexpr uint32_t digit_bits         = 8;
+        constexpr uint32_t bucket_count       = 1u << digit_bits;
+        constexpr size_t   block_size         = 4096;
+        constexpr size_t   parallel_threshold = 4 * block_size;
+
+        using histogram = std::array<uint32_t, bucket_count>;
+
+        template<typename F>
+        JobError for_each_block(const size_t blocks, F&& func)
+        {
+            if (blocks != 1) return JobSystem::parallel_for<size_t>(0, blocks, 1, func);
+
+            func(size_t{ 0 });
+            return JobError::Success;
+        }
+    }
+
+    void radix_sort(std::vector<SortEntry>& entries, std::vector<SortEntry>& scratch)
+    {
+        BOZA_PROFILE_FUNCTION();
+
+        const size_t count = entries.size();
+        if (count < 2) return;
+
+        uint64_t varying = 0;
+        for (const auto& [key, index] : entries)
+            varying |= key ^ entries[0].key;
+        if (varying == 0) return;
+
+        const size_t blocks = count < parallel_threshold ? 1 : (count + block_size - 1) / block_size;
+
+        std::vector<histogram> histograms(blocks);
+        scratch.resize(count);
+
+        const SortEntry* source      = entries.data();
+        SortEntry*       destination = scratch.data();
+
+        // only reads source, so a failed pass can simply be run again
+        const auto sort_pass = [&](const uint32_t shift, const size_t pass_blocks)
+        {
+            const size_t span   = pass_blocks == 1 ? count : block_size;
+            const auto   counts = std::span{ histograms }.first(pass_blocks);
+
+            const JobError error = for_each_block(pass_blocks, [&](const size_t block)
+            {
+                histogram& digits = counts[block];
+                digits.fill(0);
+
+                const size_t first = block * span;
+                const size_t last  = std::min(first + span, count);
+                for (size_t i = first; i < last; ++i)
+                    ++digits[source[i].key >> shift & bucket_count - 1];
+            });
+            if (error != JobError::Success) return error;
+
+            // digit-major, block-minor offsets keep equal digits in their original order
+            uint32_t offset = 0;
+            for (uint32_t digit = 0; digit < bucket_count; ++digit)
+            {
+                for (auto& digits : counts)
+                {
+                    const uint32_t bucket = digits[digit];
+                    digits[digit] = offset;
+                    offset += bucket;
+                }
+            }
+
+            return for_each_block(pass_blocks, [&](const size_t block)
+            {
+                histogram& offsets = counts[block];
+
+                const size_t first = block * span;
+                const size_t last  = std::min(first + span, count);
+                for (size_t i = first; i < last; ++i)
+                    destination[offsets[source[i].key >> shift & bucket_count - 1]++] = source[i];
+            });
+        };
+
+        for (uint32_t shift = 0; shift < 64; shift += digit_bits)
+        {
+            if ((varying >> shift & bucket_count - 1) == 0) continue;
+
+            if (sort_pass(shift, blocks) != JobError::Success)
+                (void)sort_pass(shift, 1);
+
+            source = destination;
+            destination = destination == scratch.data() ? entries.data() : scratch.data();
+        }
+
+        if (source == scratch.data()) entries.swap(scratch);
+    }
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include "boza_pch.hpp"
+
+namespace boza
+{
+    struct SortEntry
+    {
+        uint64_t key;
+        uint32_t index;
+    };
+
+    // Stable LSD radix sort on 8-bit digits. Digits that are identical across every key are skipped, and large
+    // inputs are counted and scattered in fixed blocks on the job system. scratch only keeps its capacity.
+    void radix_sort(std::vector<SortEntry>& entries, std::vector<SortEntry>& scratch);
+}
@@ -4,9 +4,14 @@
 #include "GPU/Vulkan/Core/Device.hpp"
 #include "GPU/Vulkan/Core/Swapchain.hpp"
 #include "GPU/Vulkan/Core/CommandPool.hpp"
+#include "GPU/Vulkan/Core/FrameCommandPools.hpp"
 #include "GPU/Vulkan/Memory/Allocator.hpp"
+#include "GPU/Vulkan/Memory/StagingRing.hpp"
+#include "GPU/Vulkan/Memory/UniformRing.hpp"
 #include "GPU/Vulkan/Descriptor/DescriptorPool.hpp"
 #include "MeshManager.hpp"
+#include "Core/JobSystem/JobSystem.hpp"
+#include "Profiler.hpp"
 
 
 namespace boza
@@ -22,9 +27,15 @@ namespace boza
         if (!try_(Instance::create("Boza app"), "Failed to create vulkan instance!")) return false;
         if (!try_(Device::create(), "Failed to create logical device!")) return false;
         if (!try_(CommandPool::create(), "Failed to create command pool!")) return false;
+        if (!try_(FrameCommandPools::create(), "Failed to create frame command pools!")) return false;
         if (!try_(Allocator::create(), "Failed to create VMA allocator!")) return false;
+        if (!try_(StagingRing::create(), "Failed to create staging ring!")) return false;
+        if (!try_(UniformRing::create(), "Failed to create uniform ring!")) return false;
         if (!try_(DescriptorPool::create(), "Failed to create descriptor pool!")) return false;
         if (!try_(Swapchain::create(), "Failed to create swapchain!")) return false;
+        if (!try_(PipelineManager::load_pipeline_cache(), "Failed to create pipeline cache!")) return false;
+        if (!PipelineManager::prewarm("shaders/variants.json")) Logger::warn("Shader prewarming skipped");
+        if (!try_(GpuCulling::create(), "Failed to create GPU culling!")) return false;
 
         auto& inst = instance();
 
@@ -41,17 +52,21 @@ namespace boza
         inst.texture_binding = descriptor_set.add_image_sampler(VK_SHADER_STAGE_FRAGMENT_BIT);
         descriptor_set.create();
 
-        descriptor_set.update_buffer(inst.binding0, UBO1{ .offset = { 0.0f, 0.0f } });
-        descriptor_set.update_buffer(inst.binding1, UBO2{ .scale = { 1.0f, 1.0f } });
         descriptor_set.update_image_sampler(inst.texture_binding, inst.texture);
 
+        const material_id_t default_material = register_material(descriptor_set);
+
+        const VertexLayout instanced_layout = get_layout<Vertex, InstanceData>();
+
         const pipeline_id_t default_pipeline = PipelineManager::create_pipeline(
             "shaders/default.vert",
-            "shaders/default.frag");
+            "shaders/default.frag",
+            instanced_layout);
 
         const pipeline_id_t default_pipeline2 = PipelineManager::create_pipeline(
             "shaders/default.vert",
-            "shaders/test.frag");
+            { "shaders/default.frag", 0b1 }, // INVERT
+            instanced_layout);
 
         if (default_pipeline == INVALID_PIPELINE_ID) return false;
         if (default_pipeline2 == INVALID_PIPELINE_ID) return false;
@@ -79,8 +94,8 @@ namespace boza
             return false;
         }
 
-        submit({ mesh1, default_pipeline });
-        submit({ mesh1, default_pipeline2 });
+        submit({ mesh1, default_pipeline, {}, default_material });
+        submit({ mesh1, default_pipeline2, {}, default_material });
         // submit({ mesh3, default_pipeline });
 
         return true;
@@ -88,15 +103,25 @@ namespace boza
 
     void Renderer::shutdown()
     {
+        // uploads may still reference the texture and meshes
+        StagingRing::destroy();
+
         instance().texture.destroy();
         instance().descriptor_set.destroy();
 
+        for (auto& buffer : instance().instance_buffers)
+            buffer.destroy();
+        instance().instance_capacities = {};
+
+        GpuCulling::destroy();
+        UniformRing::destroy();
         MeshManager::cleanup();
         PipelineManager::cleanup();
 
         Swapchain::destroy();
         DescriptorPool::destroy();
         Allocator::destroy();
+        FrameCommandPools::destroy();
         CommandPool::destroy();
         Device::destroy();
         Instance::destroy();
@@ -105,6 +130,14 @@ namespace boza
 
     bool Renderer::render()
     {
+        BOZA_PROFILE_FUNCTION();
+
+        if (!StagingRing::flush())
+        {
+            Logger::error("Failed to flush staging uploads!");
+            return false;
+        }
+
         const auto image_idx = Swapchain::acquire_next_image();
         if (image_idx == SKIP_IMAGE_IDX) return true;
         if (image_idx == INVALID_IMAGE_IDX)
@@ -113,51 +146,75 @@ namespace boza
             return false;
         }
 
-        if (!Swapchain::begin_render_pass(image_idx))
+        UniformRing::begin_frame();
+        MeshManager::begin_frame();
+        PipelineManager::begin_frame();
+        PipelineManager::autosave_pipeline_cache();
+
+        if (!FrameCommandPools::begin_frame())
         {
-            Logger::error("Failed to begin render pass!");
+            Logger::error("Failed to reset frame command pools!");
+            return false;
+        }
+
+        if (!DescriptorPool::begin_frame())
+        {
+            Logger::error("Failed to reset frame descriptor pools!");
+            return false;
+        }
+
+        auto& inst = instance();
+
+        if (!inst.build_draw_groups())
+        {
+            Logger::error("Failed to write instance data!");
+            return false;
+        }
+
+        if (!Swapchain::begin_command_buffer())
+        {
+            Logger::error("Failed to begin frame command buffer!");
             return false;
         }
 
         const auto& command_buffer = Swapchain::get_current_command_buffer();
 
+        if (!inst.indirect_batches.empty() && !GpuCulling::record_cull(command_buffer, inst.view_projection))
+        {
+            Logger::error("Failed to record GPU culling!");
+            return false;
+        }
+
+        const bool parallel = inst.draw_groups.size() >= parallel_record_threshold;
+
+        if (!Swapchain::begin_render_pass(image_idx, parallel))
+        {
+            Logger::error("Failed to begin render pass!");
+            return false;
+        }
+
         static float angle = 0.0f;
         if (angle >= 360.0f) angle = 0.0f;
         ++angle;
 
         const float rad_angle = glm::radians(angle);
 
-        instance().descriptor_set.update_buffer(instance().binding0, UBO1{ .offset = { cos(rad_angle) * 0.3, sin(rad_angle) * 0.3 } });
-        instance().descriptor_set.update_buffer(instance().binding1, UBO2{ .scale = { 0.5, 0.5 } });
-
-        vkCmdBindDescriptorSets(
-            command_buffer,
-            VK_PIPELINE_BIND_POINT_GRAPHICS,
-            PipelineManager::get_pipeline(instance().render_queue[0].pipeline).get_layout(),
-            0, 1,
-            &instance().descriptor_set.get_descriptor_set(),
-            0, nullptr);
+        inst.descriptor_set.update_buffer(inst.binding0, UBO1{ .offset = { cos(rad_angle) * 0.3, sin(rad_angle) * 0.3 } });
+        inst.descriptor_set.update_buffer(inst.binding1, UBO2{ .scale = { 0.5, 0.5 } });
 
+        const PushConstant push_constant {
+            .rotation_angle = rad_angle
+        };
 
-        for (const auto& [mesh, pipeline] : instance().render_queue)
+        if (!parallel)
         {
-            PipelineManager::bind_pipeline(command_buffer, pipeline);
-
-            PushConstant push_constant {
-                .rotation_angle = rad_angle
-            };
-
-            vkCmdPushConstants(
-                command_buffer,
-                PipelineManager::get_pipeline(pipeline).get_layout(),
-                VK_SHADER_STAGE_VERTEX_BIT,
-                0,
-                sizeof(PushConstant),
-                &push_constant
-            );
-
-            MeshManager::bind(command_buffer, mesh);
-            MeshManager::draw(command_buffer, mesh);
+            inst.record_indirect(command_buffer, push_constant);
+            inst.record_draws(command_buffer, 0, inst.draw_groups.size(), push_constant);
+        }
+        else if (!inst.record_parallel(command_buffer, push_constant))
+        {
+            Logger::error("Failed to record secondary command buffers!");
+            return false;
         }
 
         if (!Swapchain::end_render_pass(image_idx))
@@ -179,4 +236,288 @@ namespace boza
     {
         instance().render_queue.push_back(object);
     }
+
+    bool Renderer::record_parallel(const VkCommandBuffer primary, const PushConstant& push_constant)
+    {
+        BOZA_PROFILE_FUNCTION();
+
+        const size_t group_count = draw_groups.size();
+        const auto   chunks      = static_cast<uint32_t>(std::min<size_t>(
+            FrameCommandPools::get_slot_count(),
+            (group_count + min_groups_per_secondary - 1) / min_groups_per_secondary));
+
+        const uint32_t first_chunk = indirect_batches.empty() ? 0 : 1;
+        secondaries.assign(first_chunk + chunks, nullptr);
+
+        // recorded before the workers start, so sharing slot 0 with the first chunk is safe
+        if (first_chunk != 0)
+        {
+            const VkCommandBuffer command_buffer = FrameCommandPools::get_secondary(0);
+            if (command_buffer == nullptr || !Swapchain::begin_secondary(command_buffer)) return false;
+
+            record_indirect(command_buffer, push_constant);
+
+            VK_CHECK(vkEndCommandBuffer(command_buffer),
+            {
+                LOG_VK_ERROR("Failed to end secondary command buffer");
+                return false;
+            });
+
+            secondaries[0] = command_buffer;
+        }
+
+        std::atomic_bool failed{ false };
+
+        // contiguous ranges keep most of the sorted state coherence; each chunk owns the pool slot of its index
+        const JobError error = JobSystem::parallel_for<uint32_t>(0, chunks, 1, [&](const uint32_t chunk)
+        {
+            const VkCommandBuffer command_buffer = FrameCommandPools::get_secondary(chunk);
+            if (command_buffer == nullptr || !Swapchain::begin_secondary(command_buffer))
+            {
+                failed.store(true, std::memory_order_relaxed);
+                return;
+            }
+
+            record_draws(command_buffer, group_count * chunk / chunks, group_count * (chunk + 1) / chunks, push_constant);
+
+            VK_CHECK(vkEndCommandBuffer(command_buffer),
+            {
+                LOG_VK_ERROR("Failed to end secondary command buffer");
+                failed.store(true, std::memory_order_relaxed);
+                return;
+            });
+
+            secondaries[first_chunk + chunk] = command_buffer;
+        });
+
+        if (error != JobError::Success || failed.load(std::memory_order_relaxed)) return false;
+
+        vkCmdExecuteCommands(primary, static_cast<uint32_t>(secondaries.size()), secondaries.data());
+        return true;
+    }
+
+    void Renderer::record_draws(
+        const VkCommandBuffer command_buffer,
+        const size_t          first_group,
+        const size_t          last_group,
+        const PushConstant&   push_constant) const
+    {
+        if (first_group == last_group) return;
+
+        constexpr VkDeviceSize instance_offset = 0;
+        const VkBuffer         instance_buffer = instance_buffers[Swapchain::current_frame_idx()].get_buffer();
+        if (instance_buffer != nullptr) vkCmdBindVertexBuffers(command_buffer, 1, 1, &instance_buffer, &instance_offset);
+
+        BindState state{};
+        for (size_t i = first_group; i < last_group; ++i)
+        {
+            const auto& [mesh, pipeline, material, first_instance, instance_count] = draw_groups[i];
+
+            bind_state(command_buffer, state, pipeline, material, mesh, push_constant);
+            MeshManager::draw(command_buffer, mesh, instance_count, first_instance);
+        }
+    }
+
+    void Renderer::record_indirect(const VkCommandBuffer command_buffer, const PushConstant& push_constant) const
+    {
+        if (indirect_batches.empty()) return;
+
+        GpuCulling::bind_instances(command_buffer);
+
+        BindState state{};
+        for (uint32_t i = 0; i < indirect_batches.size(); ++i)
+        {
+            const auto& [mesh, pipeline, material, first_command, max_count] = indirect_batches[i];
+
+            bind_state(command_buffer, state, pipeline, material, mesh, push_constant);
+            GpuCulling::draw_batch(command_buffer, i, first_command, max_count);
+        }
+    }
+
+    void Renderer::bind_state(
+        const VkCommandBuffer command_buffer,
+        BindState&            state,
+        const pipeline_id_t   pipeline,
+        const material_id_t   material,
+        const mesh_id_t       mesh,
+        const PushConstant&   push_constant) const
+    {
+        if (pipeline != state.pipeline)
+        {
+            PipelineManager::bind_pipeline(command_buffer, pipeline);
+            state.pipeline = pipeline;
+
+            // push constants and sets survive pipeline binds as long as the layout stays the same
+            if (const VkPipelineLayout layout = PipelineManager::get_pipeline(pipeline).get_layout(); layout != state.layout)
+            {
+                vkCmdPushConstants(command_buffer, layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(PushConstant), &push_constant);
+                state.layout   = layout;
+                state.material = INVALID_MATERIAL_ID;
+            }
+        }
+
+        if (material != state.material && material != INVALID_MATERIAL_ID)
+        {
+            materials[material]->bind(command_buffer, state.layout);
+            state.material = material;
+        }
+
+        if (mesh != state.mesh)
+        {
+            MeshManager::bind(command_buffer, mesh, state.mesh);
+            state.mesh = mesh;
+        }
+    }
+
+    material_id_t Renderer::register_material(DescriptorSet& descriptor_set)
+    {
+        auto& inst = instance();
+        inst.materials.push_back(&descriptor_set);
+        return static_cast<material_id_t>(inst.materials.size() - 1);
+    }
+
+    void Renderer::set_view_projection(const glm::mat4& view_projection) { instance().view_projection = view_projection; }
+
+    uint64_t Renderer::make_sort_key(const RenderObject& object, const pipeline_id_t resolved_pipeline)
+    {
+        // non-negative floats order like their bit patterns; the top half keeps exponent and 7 mantissa bits
+        const uint64_t depth    = std::bit_cast<uint32_t>(std::max(object.depth, 0.0f)) >> 16;
+        const uint64_t layer    = static_cast<uint64_t>(object.layer) << 62;
+        const uint64_t pipeline = resolved_pipeline & 0x3FFF;
+        const uint64_t material = object.material & 0xFFFF;
+        const uint64_t mesh     = object.mesh & 0xFFFF;
+
+        // blending needs strict back to front order, state only breaks ties
+        if (object.layer == RenderLayer::Transparent)
+            return layer | (0xFFFF - depth) << 46 | pipeline << 32 | material << 16 | mesh;
+
+        // state first so equal state ends up contiguous, front to back within it for early depth rejection
+        return layer | pipeline << 48 | material << 32 | mesh << 16 | depth;
+    }
+
+    Renderer::InstanceData Renderer::get_instance_data(const RenderObject& object)
+    {
+        if (object.transform == INVALID_TRANSFORM_NODE) return object.instance;
+        return { .model = TransformHierarchy::get_world_matrix(object.transform) };
+    }
+
+    bool Renderer::build_draw_groups()
+    {
+        BOZA_PROFILE_FUNCTION();
+
+        draw_groups.clear();
+        indirect_batches.clear();
+        gpu_objects.clear();
+
+        const bool cull_on_gpu = GpuCulling::is_supported();
+
+        const auto object_count = static_cast<uint32_t>(render_queue.size());
+        if (object_count == 0) return !cull_on_gpu || GpuCulling::upload({}, 0);
+
+        // pipelines still building resolve to their fallback, or leave the object out of this frame
+        resolved_pipelines.resize(object_count);
+        sort_entries.clear();
+        for (uint32_t i = 0; i < object_count; ++i)
+        {
+            resolved_pipelines[i] = PipelineManager::resolve(render_queue[i].pipeline);
+            if (resolved_pipelines[i] != INVALID_PIPELINE_ID)
+                sort_entries.push_back({ make_sort_key(render_queue[i], resolved_pipelines[i]), i });
+        }
+
+        radix_sort(sort_entries, sort_scratch);
+
+        // blending needs its order across every draw, so only opaque objects leave the CPU
+        const auto cpu_count = cull_on_gpu
+            ? static_cast<uint32_t>(std::ranges::count(render_queue, RenderLayer::Transparent, &RenderObject::layer))
+            : object_count;
+
+        const uint32_t frame    = Swapchain::current_frame_idx();
+        Buffer&        buffer   = instance_buffers[frame];
+        uint32_t&      capacity = instance_capacities[frame];
+
+        if (cpu_count > capacity)
+        {
+            capacity = std::max({ cpu_count, capacity * 2, 1024u });
+
+            buffer.destroy();
+            buffer = Buffer::create(capacity * sizeof(InstanceData), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
+
+            if (buffer.get_buffer() == nullptr)
+            {
+                capacity = 0;
+                return false;
+            }
+        }
+
+        const uint32_t max_draw_count = cull_on_gpu ? GpuCulling::get_max_draw_count() : 0;
+
+        auto*    instances      = static_cast<InstanceData*>(buffer.get_mapped_data());
+        uint32_t instance_count = 0;
+
+        for (const auto& [key, index] : sort_entries)
+        {
+            // keys truncate ids, so group boundaries compare the objects themselves
+            const RenderObject& object   = render_queue[index];
+            const pipeline_id_t pipeline = resolved_pipelines[index];
+
+            if (cull_on_gpu && object.layer == RenderLayer::Opaque)
+            {
+                add_indirect(object, pipeline, max_draw_count);
+                continue;
+            }
+
+            instances[instance_count] = get_instance_data(object);
+
+            if (!draw_groups.empty())
+            {
+                DrawGroup& last = draw_groups.back();
+                if (last.mesh == object.mesh && last.pipeline == pipeline && last.material == object.material)
+                {
+                    ++last.instance_count;
+                    ++instance_count;
+                    continue;
+                }
+            }
+
+            draw_groups.push_back({ object.mesh, pipeline, object.material, instance_count++, 1 });
+        }
+
+        return !cull_on_gpu || GpuCulling::upload(gpu_objects, static_cast<uint32_t>(indirect_batches.size()));
+    }
+
+    void Renderer::add_indirect(const RenderObject& object, const pipeline_id_t pipeline, const uint32_t max_draw_count)
+    {
+        const Mesh& mesh    = MeshManager::get_mesh(object.mesh);
+        const auto  command = static_cast<uint32_t>(gpu_objects.size());
+
+        // one multi-draw covers any meshes in the same pools under the same pipeline and material
+        bool new_batch = indirect_batches.empty();
+        if (!new_batch)
+        {
+            const IndirectBatch& last      = indirect_batches.back();
+            const Mesh&          last_mesh = MeshManager::get_mesh(last.mesh);
+
+            new_batch = last.pipeline != pipeline ||
+                        last.material != object.material ||
+                        last_mesh.vertex_pool != mesh.vertex_pool ||
+                        last_mesh.index_pool != mesh.index_pool ||
+                        last.max_count == max_draw_count;
+        }
+
+        if (new_batch) indirect_batches.push_back({ object.mesh, pipeline, object.material, command, 0 });
+
+        IndirectBatch& batch = indirect_batches.back();
+        ++batch.max_count;
+
+        gpu_objects.push_back({
+            .model = get_instance_data(object).model,
+            .bounds = mesh.bounds,
+            .index_count = mesh.index_count,
+            .first_index = mesh.first_index,
+            .vertex_offset = mesh.vertex_offset,
+            .first_command = batch.first_command,
+            .batch = static_cast<uint32_t>(indirect_batches.size() - 1),
+            .padding = {}
+        });
+    }
 }
@@ -2,18 +2,45 @@
 #include "Singleton.hpp"
 #include "Mesh.hpp"
 #include "MeshManager.hpp"
+#include "RadixSort.hpp"
+#include "GpuCulling.hpp"
+#include "Core/TransformHierarchy.hpp"
 #include "GPU/Vulkan/Pipeline/PipelineManager.hpp"
 #include "GPU/Vulkan/Descriptor/DescriptorSet.hpp"
+#include "GPU/Vulkan/Core/Swapchain.hpp"
 
 namespace boza
 {
+    using material_id_t = uint32_t;
+    constexpr material_id_t INVALID_MATERIAL_ID = std::numeric_limits<material_id_t>::max();
+
+    // Drawn in enum order; opaque front to back, transparent back to front.
+    enum class RenderLayer : uint8_t
+    {
+        Opaque,
+        Transparent
+    };
+
     class Renderer final : public Singleton<Renderer>
     {
     public:
+        // Fed to binding 1 of pipelines created with get_layout<Vertex, InstanceData>().
+        struct InstanceData
+        {
+            glm::mat4 model{ 1.0f };
+        };
+
         struct RenderObject
         {
             mesh_id_t mesh;
             pipeline_id_t pipeline;
+            InstanceData instance{};
+            material_id_t material{ INVALID_MATERIAL_ID };
+            RenderLayer layer{ RenderLayer::Opaque };
+            // view-space distance, only used for ordering
+            float depth{ 0.0f };
+            // when set, the model matrix is the node's world matrix as of the last TransformHierarchy::update()
+            transform_node_t transform{ INVALID_TRANSFORM_NODE };
         };
 
         static bool initialize();
@@ -23,6 +50,13 @@ namespace boza
 
         static void submit(const RenderObject& object);
 
+        // The set must outlive every object submitted with the returned id.
+        static material_id_t register_material(DescriptorSet& descriptor_set);
+
+        // Frustum used for GPU culling; identity culls against clip space. Opaque objects are culled and drawn from
+        // the GPU whenever the device can draw with an indirect count, transparent ones always keep their CPU order.
+        static void set_view_projection(const glm::mat4& view_projection);
+
     private:
         struct Vertex
         {
@@ -46,12 +80,71 @@ namespace boza
             float rotation_angle;
         };
 
+        // consecutive sorted objects sharing pipeline, material and mesh, drawn as one instanced draw
+        struct DrawGroup
+        {
+            mesh_id_t     mesh;
+            pipeline_id_t pipeline;
+            material_id_t material;
+            uint32_t      first_instance;
+            uint32_t      instance_count;
+        };
+
+        // opaque objects culled on the GPU into [first_command, first_command + max_count) of the command buffer;
+        // mesh is any member and only picks the geometry pools, which every member shares
+        struct IndirectBatch
+        {
+            mesh_id_t     mesh;
+            pipeline_id_t pipeline;
+            material_id_t material;
+            uint32_t      first_command;
+            uint32_t      max_count;
+        };
+
+        struct BindState
+        {
+            pipeline_id_t    pipeline{ INVALID_PIPELINE_ID };
+            VkPipelineLayout layout{ nullptr };
+            material_id_t    material{ INVALID_MATERIAL_ID };
+            mesh_id_t        mesh{ INVALID_MESH_ID };
+        };
+
+        // below this many groups a single thread records straight into the primary command buffer
+        static constexpr size_t parallel_record_threshold = 256;
+        static constexpr size_t min_groups_per_secondary  = 64;
+
+        [[nodiscard]] static uint64_t     make_sort_key(const RenderObject& object, pipeline_id_t resolved_pipeline);
+        [[nodiscard]] static InstanceData get_instance_data(const RenderObject& object);
+        [[nodiscard]] bool            build_draw_groups();
+        void                          add_indirect(const RenderObject& object, pipeline_id_t pipeline, uint32_t max_draw_count);
+        [[nodiscard]] bool            record_parallel(VkCommandBuffer primary, const PushConstant& push_constant);
+        void                          record_draws(VkCommandBuffer command_buffer, size_t first_group, size_t last_group, const PushConstant& push_constant) const;
+        void                          record_indirect(VkCommandBuffer command_buffer, const PushConstant& push_constant) const;
+        void                          bind_state(
+            VkCommandBuffer command_buffer, BindState& state,
+            pipeline_id_t pipeline, material_id_t material, mesh_id_t mesh, const PushConstant& push_constant) const;
+
         DescriptorSet descriptor_set{};
         Texture texture{};
         descriptor_set_binding binding0{};
         descriptor_set_binding binding1{};
         descriptor_set_binding texture_binding{};
         std::vector<RenderObject> render_queue;
+        std::vector<DescriptorSet*> materials;
+
+        std::vector<pipeline_id_t> resolved_pipelines;
+        std::vector<SortEntry> sort_entries;
+        std::vector<SortEntry> sort_scratch;
+        std::vector<DrawGroup> draw_groups;
+        std::vector<VkCommandBuffer> secondaries;
+
+        std::vector<IndirectBatch>      indirect_batches;
+        std::vector<GpuCulling::Object> gpu_objects;
+        glm::mat4                       view_projection{ 1.0f };
+
+        // per frame in flight, grown on demand once that frame's fence has signalled
+        std::array<Buffer, Swapchain::max_frames_in_flight>   instance_buffers{};
+        std::array<uint32_t, Swapchain::max_frames_in_flight> instance_capacities{};
 
         friend Singleton;
         Renderer() = default;
@@ -1,6 +1,7 @@
 #pragma once
 #include "boza_pch.hpp"
 #include "SystemBase.hpp"
+#include "Profiler.hpp"
 
 namespace boza
 {
@@ -41,7 +42,12 @@ namespace boza
                 last_time         = current_time;
 
                 delta_time.store(time_elapsed);
-                this->on_iteration();
+                BOZA_PROFILE_COUNTER("Frame time (ms)", std::chrono::duration<double, std::milli>(time_elapsed).count());
+
+                {
+                    BOZA_PROFILE_ZONE(entt::type_name<Derived>::value());
+                    this->on_iteration();
+                }
 
                 if (capped_framerate.load() && time_elapsed < min_delta_time.load())
                     std::this_thread::sleep_for(min_delta_time.load() - time_elapsed);
@@ -19,6 +19,8 @@
 #include <sstream>
 
 #include <algorithm>
+#include <numeric>
+#include <bit>
 #include <functional>
 #include <memory>
 #include <string>